@@ -0,0 +1,304 @@
+#include <algorithm>
+#include <climits>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// CHECKED_LOCKS follows NDEBUG unless you set it yourself (e.g. -DCHECKED_LOCKS=1 for a release build with checks)
+#ifndef CHECKED_LOCKS
+#ifdef NDEBUG
+#define CHECKED_LOCKS 0
+#else
+#define CHECKED_LOCKS 1
+#endif
+#endif
+
+#if CHECKED_LOCKS
+
+namespace lockdep {
+// global lock-order graph (like the Linux kernel's lockdep)...
+// ...an edge A -> B means "somebody locked B while holding A"; a cycle means two threads *could* deadlock,...
+// ...even if the timing never lined up for them to actually do it
+class graph {
+public:
+    static graph& instance()
+    {
+        static graph g;
+        return g;
+    }
+
+    void add_node(const void *m, std::string name)
+    {
+        std::lock_guard lock(m_);
+        names_[m] = std::move(name);
+    }
+
+    void remove_node(const void *m)
+    {
+        std::lock_guard lock(m_);
+        names_.erase(m);
+        edges_.erase(m);
+        for (auto &[from, to] : edges_) { to.erase(m); }
+    }
+
+    void before_lock(const void *m)
+    {
+        std::lock_guard lock(m_);
+
+        for (const void *h : held()) {
+            if (h == m) { report({ m, m }, "recursive locking"); continue; }
+            if (!edges_[h].insert(m).second) { continue; } // seen this order before
+
+            // new edge h -> m... if m could already reach h, we've just closed a loop
+            std::vector<const void*> path;
+            std::unordered_set<const void*> visited;
+            if (find_path(m, h, path, visited)) {
+                path.push_back(m);
+                report(path, "lock order cycle");
+            }
+        }
+    }
+
+    void after_lock(const void *m) { held().push_back(m); }
+
+    void on_unlock(const void *m)
+    {
+        auto &h = held();
+        auto it = std::find(h.rbegin(), h.rend(), m);
+        if (it != h.rend()) { h.erase(std::next(it).base()); }
+    }
+
+private:
+    std::mutex m_;
+    std::unordered_map<const void*, std::string> names_;
+    std::unordered_map<const void*, std::unordered_set<const void*>> edges_;
+
+    static std::vector<const void*>& held()
+    {
+        static thread_local std::vector<const void*> held_locks;
+        return held_locks;
+    }
+
+    bool find_path(const void *from, const void *to, std::vector<const void*> &path, std::unordered_set<const void*> &visited)
+    {
+        if (!visited.insert(from).second) { return false; }
+
+        path.push_back(from);
+        if (from == to) { return true; }
+
+        auto it = edges_.find(from);
+        if (it != edges_.end()) {
+            for (const void *next : it->second)
+                if (find_path(next, to, path, visited)) { return true; }
+        }
+
+        path.pop_back();
+        return false;
+    }
+
+    void report(const std::vector<const void*> &path, const char *what)
+    {
+        std::cerr << "lockdep: " << what << ": ";
+        for (std::size_t i = 0; i != path.size(); ++i) {
+            std::cerr << (i ? " -> " : "") << names_[path[i]];
+        } std::cerr << '\n';
+    }
+};
+
+// drop-in for std::mutex - no hierarchy numbers, just a name for the report
+class mutex {
+public:
+    explicit mutex(const char *name = "unnamed") { graph::instance().add_node(this, name); }
+    ~mutex() { graph::instance().remove_node(this); }
+
+    mutex(const mutex&) = delete;
+    mutex& operator=(const mutex&) = delete;
+
+    void lock()
+    {
+        graph::instance().before_lock(this);
+        internal_mutex_.lock();
+        graph::instance().after_lock(this);
+    }
+
+    // a successful try_lock() can't deadlock, so it's held but doesn't add any edges
+    bool try_lock()
+    {
+        if (!internal_mutex_.try_lock()) { return false; }
+        graph::instance().after_lock(this);
+        return true;
+    }
+
+    void unlock()
+    {
+        graph::instance().on_unlock(this);
+        internal_mutex_.unlock();
+    }
+
+private:
+    std::mutex internal_mutex_;
+};
+} // namespace lockdep
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// same as hierarchical_mutex.cpp, but built on top of lockdep::mutex so it shows up in the graph too
+class hierarchical_mutex {
+public:
+    explicit hierarchical_mutex(unsigned long value, const char *name = "hierarchical")
+        : internal_mutex(name), hierarchy_value(value), previous_hierarchy_value(0) { }
+
+    void lock()
+    {
+        check_for_hierarchy_violation();
+        internal_mutex.lock();
+        update_hierarchy_value();
+    }
+
+    void unlock()
+    {
+        if (this_thread_hierarchy_value != hierarchy_value) {
+            throw std::logic_error("\"mutex hierarchy violated\"\n");
+        }
+
+        this_thread_hierarchy_value = previous_hierarchy_value;
+        internal_mutex.unlock();
+    }
+
+    bool try_lock()
+    {
+        check_for_hierarchy_violation();
+        if (!internal_mutex.try_lock()) { return false; }
+        update_hierarchy_value();
+        return true;
+    }
+
+private:
+    lockdep::mutex internal_mutex;
+
+    const unsigned long hierarchy_value;
+    unsigned long previous_hierarchy_value;
+
+    static thread_local unsigned long this_thread_hierarchy_value;
+
+    void check_for_hierarchy_violation()
+    {
+        if (this_thread_hierarchy_value <= hierarchy_value) {
+            throw std::logic_error("\"mutex hierarchy violated\"\n");
+        }
+    }
+
+    void update_hierarchy_value()
+    {
+        previous_hierarchy_value = this_thread_hierarchy_value;
+        this_thread_hierarchy_value = hierarchy_value;
+    }
+};
+
+thread_local unsigned long hierarchical_mutex::this_thread_hierarchy_value(ULONG_MAX);
+
+#else
+
+// release builds - no graph, no thread_local, no throwing; just a plain std::mutex
+// the constructors take exactly what the checked ones do, so anything that builds one way builds the other
+namespace lockdep {
+class mutex : public std::mutex {
+public:
+    explicit mutex(const char* = "unnamed") { }
+};
+} // namespace lockdep
+
+class hierarchical_mutex : public std::mutex {
+public:
+    explicit hierarchical_mutex(unsigned long, const char* = "hierarchical") { }
+};
+
+#endif // CHECKED_LOCKS
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+lockdep::mutex accounts_mutex("accounts");
+lockdep::mutex audit_mutex("audit");
+lockdep::mutex log_mutex("log");
+
+void transfer() {
+    std::lock_guard lock1(accounts_mutex);
+    std::lock_guard lock2(audit_mutex);
+    std::cout << "transfer: accounts -> audit\n";
+}
+
+void audit() {
+    std::lock_guard lock1(audit_mutex);
+    std::lock_guard lock2(log_mutex);
+    std::cout << "audit:    audit -> log\n";
+}
+
+void rotate_log() {
+    std::lock_guard lock1(log_mutex);
+    std::lock_guard lock2(accounts_mutex); // accounts -> audit -> log -> accounts...
+    std::cout << "rotate:   log -> accounts\n";
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+hierarchical_mutex high_level_mutex(10000, "high_level");
+hierarchical_mutex low_level_mutex(5000, "low_level");
+
+int low_level_func() {
+    std::lock_guard<hierarchical_mutex> lock(low_level_mutex);
+    return 5;
+}
+
+void high_level_func() {
+    std::lock_guard<hierarchical_mutex> lock(high_level_mutex);
+    std::cout << "woofwoof: " << low_level_func() << '\n';
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int main()
+{
+    std::cout << "CHECKED_LOCKS = " << CHECKED_LOCKS << "\n\n";
+
+    // each thread runs on its own, so nothing ever actually deadlocks...
+    // ...but the third one closes a loop in the lock-order graph
+    std::thread(transfer).join();
+    std::thread(audit).join();
+    std::thread(rotate_log).join();
+
+    std::cout << '\n';
+
+    high_level_func();
+
+    return 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//  OUTPUT - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// debug (CHECKED_LOCKS = 1)
+// CHECKED_LOCKS = 1
+//
+// transfer: accounts -> audit
+// audit:    audit -> log
+// lockdep: lock order cycle: accounts -> audit -> log -> accounts
+// rotate:   log -> accounts
+//
+// woofwoof: 5
+// Program ended with exit code: 0
+//
+// release, -DNDEBUG (CHECKED_LOCKS = 0)
+// CHECKED_LOCKS = 0
+//
+// transfer: accounts -> audit
+// audit:    audit -> log
+// rotate:   log -> accounts
+//
+// woofwoof: 5
+// Program ended with exit code: 0
@@ -0,0 +1,427 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class function_wrapper {
+public:
+    function_wrapper() = default;
+
+    function_wrapper(const function_wrapper&) = delete;
+    function_wrapper(function_wrapper&) = delete;
+    function_wrapper& operator=(const function_wrapper&) = delete;
+
+    function_wrapper(function_wrapper &&other) noexcept : impl_(std::move(other.impl_)) { }
+
+    function_wrapper& operator=(function_wrapper &&rhs) noexcept
+    {
+        impl_ = std::move(rhs.impl_);
+        return *this;
+    }
+
+    template <typename Func>
+    function_wrapper(Func &&f) noexcept : impl_(std::make_unique<impl_type<Func>>(std::move(f))) { }
+
+    void operator() () { impl_->call(); }
+
+
+private:
+    struct impl_base {
+        // abstract base class
+        virtual void call() = 0;
+        virtual ~impl_base() { }
+    };
+
+    std::unique_ptr<impl_base> impl_;
+
+    template <typename Func>
+    struct impl_type : impl_base {
+        Func f_;
+
+        impl_type(Func &&f) : f_(std::move(f)) { }
+        void call() { f_(); }
+    };
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// just enough of a pool to run continuations on (chapter 9 does these properly) - workers finish whatever's queued...
+// ...before they exit, so nothing that's been scheduled gets dropped
+class thread_pool {
+public:
+    explicit thread_pool(std::size_t thread_count = std::max(1u, std::thread::hardware_concurrency()))
+    {
+        for (std::size_t i = 0; i != thread_count; ++i) { threads_.emplace_back(&thread_pool::worker_thread, this); }
+    }
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            done_ = true;
+        }
+
+        cv_.notify_all();
+        for (auto &t : threads_) { t.join(); }
+    }
+
+    template <typename Func>
+    void submit(Func f)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            q_.push(function_wrapper(std::move(f)));
+        }
+
+        cv_.notify_one();
+    }
+
+private:
+    std::mutex m_;
+    std::condition_variable cv_;
+    std::queue<function_wrapper> q_;
+    bool done_ = false;
+
+    std::vector<std::thread> threads_;
+
+    void worker_thread()
+    {
+        while (true) {
+            function_wrapper task;
+
+            {
+                std::unique_lock<std::mutex> lock(m_);
+                cv_.wait(lock, [&] () { return done_ || !q_.empty(); });
+
+                if (q_.empty()) { return; }
+
+                task = std::move(q_.front());
+                q_.pop();
+            }
+
+            task();
+        }
+    }
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// a future with .then() - the continuation hangs off the shared state, and whoever makes the state ready hands it to...
+// ...the pool, so nobody has to sit in a .get() waiting for the value to turn up
+namespace cont {
+template <typename T> class future;
+template <typename T> class promise;
+
+template <typename T> future<std::vector<future<T>>> when_all(std::vector<future<T>> futures);
+
+template <typename Sequence> struct when_any_result;
+template <typename T> future<when_any_result<std::vector<future<T>>>> when_any(std::vector<future<T>> futures);
+
+namespace detail {
+template <typename T>
+struct shared_state {
+    explicit shared_state(thread_pool *pool) : pool_(pool) { }
+
+    thread_pool *pool_; // where .then() continuations run - nullptr runs them on whichever thread made us ready
+
+    std::mutex m_;
+    std::condition_variable cv_;
+    bool ready_ = false;
+    std::optional<T> value_;
+    std::exception_ptr error_;
+
+    std::vector<function_wrapper> callbacks_;
+
+    // f runs as soon as we're ready (straight away, if we already are) - on whichever thread made us ready, so it...
+    // ...mustn't take long (.then() only uses it to hand the real work to the pool)
+    void on_ready(function_wrapper f)
+    {
+        std::unique_lock<std::mutex> lock(m_);
+
+        if (!ready_) {
+            callbacks_.push_back(std::move(f));
+            return;
+        }
+
+        lock.unlock();
+        f();
+    }
+
+    template <typename Setter>
+    void make_ready(Setter set)
+    {
+        std::vector<function_wrapper> callbacks;
+
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            if (ready_) { throw std::future_error(std::future_errc::promise_already_satisfied); }
+
+            set();
+            ready_ = true;
+            callbacks.swap(callbacks_);
+        }
+
+        cv_.notify_all();
+        for (auto &f : callbacks) { f(); }
+    }
+};
+} // namespace detail
+
+template <typename T>
+class future {
+public:
+    future() = default;
+
+    future(future&&) = default;
+    future& operator=(future&&) = default;
+
+    bool valid() const { return state_ != nullptr; }
+
+    bool is_ready() const
+    {
+        std::lock_guard<std::mutex> lock(state_->m_);
+        return state_->ready_;
+    }
+
+    void wait() const
+    {
+        std::unique_lock<std::mutex> lock(state_->m_);
+        state_->cv_.wait(lock, [&] () { return state_->ready_; });
+    }
+
+    // same as std::future - blocks until the value's there, and can only be called once
+    T get()
+    {
+        wait();
+
+        auto state = std::move(state_);
+        if (state->error_) { std::rethrow_exception(state->error_); }
+
+        return std::move(*state->value_);
+    }
+
+    // f(future<T>) runs on the pool once we're ready, and is handed us (ready) - so it can .get() the value, or catch...
+    // ...the exception - and whatever it returns (or throws) ends up in the future we return
+    // like std::experimental::future::then, this future's no longer valid afterwards
+    template <typename Func>
+    future<std::invoke_result_t<Func&, future<T>>> then(Func f)
+    {
+        typedef std::invoke_result_t<Func&, future<T>> R;
+
+        auto state = state_;
+        promise<R> p(state->pool_);
+        auto result = p.get_future();
+
+        state->on_ready([state, f = std::move(f), self = std::move(*this), p = std::move(p)] () mutable {
+            auto run = [f = std::move(f), self = std::move(self), p = std::move(p)] () mutable {
+                try { p.set_value(f(std::move(self))); } catch (...) { p.set_exception(std::current_exception()); }
+            };
+
+            if (state->pool_) { state->pool_->submit(std::move(run)); } else { run(); }
+        });
+
+        return result;
+    }
+
+private:
+    std::shared_ptr<detail::shared_state<T>> state_;
+
+    explicit future(std::shared_ptr<detail::shared_state<T>> state) : state_(std::move(state)) { }
+
+    friend class promise<T>;
+    friend future<std::vector<future<T>>> when_all<T>(std::vector<future<T>>);
+    friend future<when_any_result<std::vector<future<T>>>> when_any<T>(std::vector<future<T>>);
+};
+
+template <typename T>
+class promise {
+public:
+    explicit promise(thread_pool *pool) : state_(std::make_shared<detail::shared_state<T>>(pool)) { }
+
+    promise(promise&&) = default;
+
+    // nobody's going to set us now - whoever's waiting gets a broken_promise instead of waiting forever
+    ~promise()
+    {
+        if (state_ && !future<T>(state_).is_ready()) {
+            set_exception(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+        }
+    }
+
+    future<T> get_future() { return future<T>(state_); }
+
+    void set_value(T value) { state_->make_ready([&] () { state_->value_.emplace(std::move(value)); }); }
+    void set_exception(std::exception_ptr e) { state_->make_ready([&] () { state_->error_ = e; }); }
+
+private:
+    std::shared_ptr<detail::shared_state<T>> state_;
+};
+
+// std::async, but on the pool
+template <typename Func>
+future<std::invoke_result_t<Func&>> async(thread_pool &pool, Func f)
+{
+    typedef std::invoke_result_t<Func&> R;
+
+    promise<R> p(&pool);
+    auto result = p.get_future();
+
+    pool.submit([f = std::move(f), p = std::move(p)] () mutable {
+        try { p.set_value(f()); } catch (...) { p.set_exception(std::current_exception()); }
+    });
+
+    return result;
+}
+
+// ready once every one of futures is, with all of them (ready) inside - every input just counts down as it becomes...
+// ...ready, and the last one makes the result ready, so nothing blocks. The count starts one higher than the number of...
+// ...inputs, and we take the extra one off ourselves once they're all hooked up - otherwise an input that's already...
+// ...ready could finish everything (and move the futures out) while we're still going through them
+template <typename T>
+future<std::vector<future<T>>> when_all(std::vector<future<T>> futures)
+{
+    struct context {
+        std::vector<future<T>> futures;
+        std::atomic<std::size_t> remaining;
+        promise<std::vector<future<T>>> p;
+
+        context(std::vector<future<T>> fs, thread_pool *pool) : futures(std::move(fs)), remaining(futures.size() + 1), p(pool) { }
+
+        void count_down() { if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) { p.set_value(std::move(futures)); } }
+    };
+
+    thread_pool *pool = futures.empty() ? nullptr : futures.front().state_->pool_;
+    auto ctx = std::make_shared<context>(std::move(futures), pool);
+
+    auto result = ctx->p.get_future();
+
+    for (auto &f : ctx->futures) { f.state_->on_ready([ctx] () { ctx->count_down(); }); }
+    ctx->count_down();
+
+    return result;
+}
+
+template <typename Sequence>
+struct when_any_result {
+    std::size_t index;
+    Sequence futures;
+};
+
+// ready as soon as the first of futures is, with its index - the rest are handed back as they are, still running
+template <typename T>
+future<when_any_result<std::vector<future<T>>>> when_any(std::vector<future<T>> futures)
+{
+    typedef when_any_result<std::vector<future<T>>> result_type;
+
+    // same trick as when_all - two things have to happen (one of the inputs is ready, and we've finished hooking them...
+    // ...all up) before the futures can be moved out, and whichever happens second does it
+    struct context {
+        std::vector<future<T>> futures;
+        std::atomic<std::size_t> index, remaining;
+        promise<result_type> p;
+
+        // nothing to wait for, and it's ready straight away with index -1
+        context(std::vector<future<T>> fs, thread_pool *pool)
+            : futures(std::move(fs)), index(static_cast<std::size_t>(-1)), remaining(futures.empty() ? 1 : 2), p(pool) { }
+
+        void count_down() { if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) { p.set_value({ index, std::move(futures) }); } }
+    };
+
+    thread_pool *pool = futures.empty() ? nullptr : futures.front().state_->pool_;
+    auto ctx = std::make_shared<context>(std::move(futures), pool);
+
+    auto result = ctx->p.get_future();
+
+    for (std::size_t i = 0; i != ctx->futures.size(); ++i) {
+        ctx->futures[i].state_->on_ready([ctx, i] () {
+            std::size_t none = static_cast<std::size_t>(-1);
+            if (ctx->index.compare_exchange_strong(none, i, std::memory_order_acq_rel)) { ctx->count_down(); }
+        });
+    }
+
+    ctx->count_down();
+
+    return result;
+}
+} // namespace cont (continuations)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// gather_results.cpp again - but the sum's a continuation of when_all(), instead of one more std::async thread that...
+// ...spends its whole life blocked in .get()
+cont::future<int> process_data(thread_pool &pool, const std::vector<int> &ivec, std::size_t chunks) {
+    std::vector<cont::future<int>> results;
+
+    for (std::size_t c = 0; c != chunks; ++c) {
+        auto b = ivec.begin() + c * ivec.size() / chunks, e = ivec.begin() + (c + 1) * ivec.size() / chunks;
+        results.push_back(cont::async(pool, [b, e] () { return std::accumulate(b, e, 0); }));
+    }
+
+    return cont::when_all(std::move(results)).then([] (cont::future<std::vector<cont::future<int>>> all) {
+        int sum = 0;
+        for (auto &f : all.get()) { sum += f.get(); }
+        return sum;
+    });
+}
+
+int main()
+{
+    // a single worker - if anything blocked in .get() waiting for the chunks, the chunks would never get to run
+    thread_pool pool(1);
+
+    std::vector<int> ivec(1000);
+    std::iota(ivec.begin(), ivec.end(), 1);
+
+    std::cout << "process_data():      " << process_data(pool, ivec, 64).get() << " (64 chunks on one worker)\n";
+
+    // a chain - every step's handed the one before it
+    auto answer = cont::async(pool, [] () { return 21; })
+        .then([] (cont::future<int> f) { return f.get() * 2; })
+        .then([] (cont::future<int> f) { return "the answer is " + std::to_string(f.get()); });
+
+    std::cout << "then().then():       " << answer.get() << '\n';
+
+    // an exception skips straight through to whoever finally calls .get()
+    auto oops = cont::async(pool, [] () -> int { throw std::runtime_error("no value for you"); })
+        .then([] (cont::future<int> f) { return f.get() + 1; });
+
+    try { oops.get(); } catch (const std::exception &e) { std::cout << "exception:           " << e.what() << '\n'; }
+
+    // whichever finishes first
+    thread_pool sleepers(3);
+    std::vector<cont::future<std::string>> racers;
+
+    for (int ms : { 300, 100, 200 }) {
+        racers.push_back(cont::async(sleepers, [ms] () {
+            std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+            return std::to_string(ms) + "ms";
+        }));
+    }
+
+    auto first = cont::when_any(std::move(racers)).get();
+    std::cout << "when_any():          racer " << first.index << " (" << first.futures[first.index].get() << ") won\n";
+
+    return 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//  OUTPUT - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// process_data():      500500 (64 chunks on one worker)
+// then().then():       the answer is 42
+// exception:           no value for you
+// when_any():          racer 1 (100ms) won
+// Program ended with exit code: 0
@@ -0,0 +1,641 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+// parrer_partial_sum.cpp's barrier - fine for par::, as there's only ever one waiter per block rather than one per element
+class barrier {
+public:
+    barrier(std::size_t count) : count_(count), spaces_(count), generation_(0) { }
+
+    void wait()
+    {
+        std::size_t my_gen = generation_.load();
+
+        if (!--spaces_) {
+            spaces_ = count_.load();
+            ++generation_;
+        } else {
+            while (generation_.load() == my_gen) { std::this_thread::yield(); }
+        }
+    }
+
+    void done_waiting()
+    {
+        --count_;
+
+        if (!--spaces_) {
+            spaces_ = count_.load();
+            ++generation_;
+        }
+    }
+
+private:
+    std::atomic<std::size_t> count_;
+
+    std::atomic<std::size_t> spaces_;
+    std::atomic<std::size_t> generation_;
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+namespace mt {
+template <typename T>
+class queue {
+public:
+    queue() : head_(std::make_unique<node>()), tail_(head_.get()) { }
+    
+    queue(const queue&) = delete;
+    queue& operator=(const queue&) = delete;
+    
+    std::shared_ptr<T> try_pop()
+    {
+        std::unique_ptr<node> old_head = try_pop_head();
+        return old_head ? old_head->data_ : std::shared_ptr<T>();
+    }
+    
+    bool try_pop(T &val)
+    {
+        std::unique_ptr<node> old_head = try_pop_head(val);
+        return old_head.get();
+    }
+    
+    std::shared_ptr<T> wait_and_pop()
+    {
+        std::unique_ptr<node> old_head = wait_pop_head();
+        return old_head->data_;
+    }
+    
+    void wait_and_pop(T &val)
+    {
+        std::unique_ptr<node> old_head = wait_pop_head(val);
+    }
+    
+    template <typename V>
+    void push(V &&val)
+    {
+        auto new_data = std::make_shared<T>(std::forward<V>(val));
+        auto p = std::make_unique<node>();
+        
+        {
+            std::lock_guard lock(tail_m);
+            tail_->data_ = new_data;
+            node *new_tail = p.get();
+            tail_->next_ = std::move(p);
+            tail_ = new_tail;
+        }
+        
+        cv.notify_one();
+    }
+    
+    bool empty() const
+    {
+        std::lock_guard lock(head_m);
+        return head_.get() == get_tail();
+    }
+    
+private:
+    struct node
+    {
+        std::shared_ptr<T> data_;
+        std::unique_ptr<node> next_;
+    };
+    
+    std::unique_ptr<node> pop_head()
+    {
+        std::unique_ptr<node> old_head = std::move(head_);
+        head_ = std::move(old_head->next_);
+        return old_head;
+    }
+    
+    std::unique_lock<std::mutex> wait_for_data()
+    {
+        std::unique_lock<std::mutex> lock(head_m);
+        cv.wait(lock, [&] () { return head_.get() != get_tail(); } );
+        return lock;
+    }
+    
+    std::unique_ptr<node> wait_pop_head()
+    {
+        std::unique_lock<std::mutex> lock(wait_for_data());
+        return pop_head();
+    }
+    
+    std::unique_ptr<node> wait_pop_head(T &val)
+    {
+        std::unique_lock<std::mutex> lock(wait_for_data());
+        val = std::move(*head_->data_);
+        return pop_head();;
+    }
+    
+    node* get_tail() const
+    {
+        std::lock_guard lock(tail_m);
+        return tail_;
+    }
+    
+    std::unique_ptr<node> try_pop_head()
+    {
+        std::lock_guard lock(head_m);
+        if (head_.get() == get_tail()) { return std::unique_ptr<node>(); }
+        return pop_head();
+    }
+    
+    std::unique_ptr<node> try_pop_head(T &val)
+    {
+        std::lock_guard lock(head_m);
+        if (head_.get() == get_tail()) { return std::unique_ptr<node>(); }
+        val = std::move(*head_->data_);
+        return pop_head();
+    }
+    
+    std::unique_ptr<node> head_;
+    node *tail_;
+    
+    mutable std::mutex head_m;
+    mutable std::mutex tail_m;
+    
+    std::condition_variable cv;
+};
+} // namespace mt (multi-threaded)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+class join_threads {
+public:
+    explicit join_threads(std::vector<std::thread> &threads) : threads_(threads) { }
+    
+    ~join_threads()
+    {
+        for (auto &t : threads_)
+            if (t.joinable()) { t.join(); }
+    }
+    
+private:
+    std::vector<std::thread> &threads_;
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+class function_wrapper {
+public:
+    function_wrapper() = default;
+    
+    function_wrapper(const function_wrapper&) = delete;
+    function_wrapper(function_wrapper&) = delete;
+    function_wrapper& operator=(const function_wrapper&) = delete;
+    
+    function_wrapper(function_wrapper &&other) noexcept : impl_(std::move(other.impl_)) { }
+    
+    function_wrapper& operator=(function_wrapper &&rhs) noexcept
+    {
+        impl_ = std::move(rhs.impl_);
+        return *this;
+    }
+    
+    template <typename Func>
+    // function_wrapper(Func &&f) : impl_(new impl_type<Func>(std::move(f))) { }
+    function_wrapper(Func &&f) noexcept : impl_(std::make_unique<impl_type<Func>>(std::move(f))) { }
+    
+    void operator() () { impl_->call(); }
+    
+    
+private:
+    struct impl_base {
+        // abstract base class
+        virtual void call() = 0;
+        virtual ~impl_base() { }
+    };
+    
+    std::unique_ptr<impl_base> impl_;
+    
+    template <typename Func>
+    struct impl_type : impl_base {
+        Func f_;
+        
+        impl_type(Func &&f) : f_(std::move(f)) { }
+        void call() { f_(); }
+    };
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// pooled_accumulate.cpp's pool, plus a way to ask whether we're already running on one of its workers
+class thread_pool {
+public:
+    explicit thread_pool(std::size_t thread_count = default_thread_count()) : done_(false), joiner_(threads_)
+    {
+        try {
+            for (std::size_t i = 0; i != thread_count; ++i)
+                threads_.push_back(std::thread(&thread_pool::worker_thread, this));
+        } catch (...) {
+            shutdown();
+            throw;
+        }
+    }
+    
+    ~thread_pool() { shutdown(); }
+    
+    template <typename Func>
+    std::future<std::invoke_result_t<Func&&>> submit(Func f)
+    {
+        typedef std::invoke_result_t<Func&&> T;
+        
+        std::packaged_task<T()> task(std::move(f));
+        std::future<T> result(task.get_future());
+        workq_.push(std::move(task));
+        
+        return result;
+    }
+    
+    // lets a thread that's waiting on the pool lend a hand - returns false if there was nothing to do
+    bool run_pending_task()
+    {
+        function_wrapper task;
+        if (!workq_.try_pop(task)) { return false; }
+        task();
+        return true;
+    }
+    
+    std::size_t thread_count() const { return threads_.size(); }
+    
+    // one team at a time - two half-started teams could otherwise each be holding workers the other is waiting for
+    std::mutex& team_mutex() { return team_m; }
+    
+    static bool on_worker_thread() { return is_worker_; }
+    
+private:
+    std::atomic<bool> done_;
+    
+    mt::queue<function_wrapper> workq_;
+    
+    std::vector<std::thread> threads_;
+    join_threads joiner_;
+    
+    std::mutex team_m;
+    
+    static inline thread_local bool is_worker_ = false;
+    
+    static std::size_t default_thread_count()
+    {
+        std::size_t hw_threads = std::thread::hardware_concurrency();
+        return hw_threads > 1 ? hw_threads - 1 : 1; // the caller makes up the numbers
+    }
+    
+    void worker_thread()
+    {
+        is_worker_ = true;
+        
+        while (!done_) {
+            function_wrapper task;
+            workq_.wait_and_pop(task);
+            task();
+        }
+    }
+    
+    // one no-op per worker to wake it up so it can see done_
+    void shutdown()
+    {
+        done_ = true;
+        for (std::size_t i = 0; i != threads_.size(); ++i) { workq_.push([] () { }); }
+    }
+};
+
+// created on first use, joined at exit
+inline thread_pool& shared_pool() {
+    static thread_pool pool;
+    return pool;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// parrer_partial_sum.cpp as it was - a thread per element, O(n log n) additions and a barrier per step
+namespace book {
+template <typename _Iterator>
+void partial_sum(_Iterator __first, _Iterator __last) {
+    typedef typename _Iterator::value_type T;
+
+    struct process_element {
+        void operator() (_Iterator __first, std::vector<T> &buffer, std::size_t i, barrier &b)
+        {
+            T &ith_element = *(__first + i);
+            bool update_source = false;
+
+            for (std::size_t step = 0, stride = 1; stride <= i; ++step, stride *= 2) {
+                T &source = step % 2 ? buffer[i]          : ith_element;
+                T &dest   = step % 2 ? ith_element        : buffer[i];
+                T &addend = step % 2 ? buffer[i - stride] : *(__first + i - stride);
+
+                dest = source + addend;
+                update_source = !(step % 2);
+                b.wait();
+            }
+
+            if (update_source) {
+                ith_element = buffer[i];
+            } else {
+                buffer[i] = ith_element;
+            }
+
+            b.done_waiting();
+        }
+    };
+
+    std::size_t length = std::distance(__first, __last);
+    if (!length) { return; }
+
+    std::vector<T> buffer(length);
+    barrier b(length);
+
+    std::vector<std::thread> threads(length - 1);
+    join_threads joiner(threads);
+
+    for (std::size_t i = 0; i != length - 1; ++i) {
+        threads[i] = std::thread(process_element(), __first, std::ref(buffer), i, std::ref(b));
+    }
+
+    process_element()(__first, buffer, length - 1, b);
+}
+} // namespace book
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// work-efficient (Blelloch) scan, one block per team member
+//   1) every member reduces its own block                                     - the leaves of the up-sweep
+//   2) up-sweep the block totals into a tree of partial sums                   - log2(m) levels
+//   3) down-sweep, turning each node into the sum of everything to its left    - log2(m) levels
+//   4) every member scans its own block, starting from its block's prefix     - the leaves of the down-sweep
+// that's O(n) additions in total (vs. O(n log n)), and a barrier per tree level (vs. one per element per step)
+namespace par {
+// below this, a block isn't worth waking a worker for
+constexpr std::size_t min_block_size = 8192;
+
+namespace detail {
+template <typename _RandomIt>
+class blelloch_team {
+public:
+    typedef typename std::iterator_traits<_RandomIt>::value_type T;
+
+    blelloch_team(_RandomIt first, _RandomIt last, std::size_t team_size)
+        : first_(first), last_(last), team_size_(team_size),
+          block_size_(std::distance(first, last) / team_size),
+          tree_(std::bit_ceil(team_size)), b_(team_size) { }
+
+    // if a member's additions throw, it still has to turn up at every barrier (or everyone else waits there forever) - so...
+    // ...from then on the whole team just goes through the motions, and whoever threw rethrows once they're through
+    void operator() (std::size_t id)
+    {
+        _RandomIt block_first = first_ + id * block_size_;
+        _RandomIt block_last = id == team_size_ - 1 ? last_ : block_first + block_size_;
+
+        std::exception_ptr error;
+
+        auto step = [&] (auto &&work) {
+            if (failed_.load()) { return; }
+
+            try {
+                work();
+            } catch (...) {
+                error = std::current_exception();
+                failed_.store(true);
+            }
+        };
+
+        // tree_ is padded out to a power of two - the padding stays T{}, which is fine for +
+        step([&] () { tree_[id] = std::accumulate(block_first, block_last, T{}); });
+        b_.wait();
+
+        std::size_t m = tree_.size();
+
+        for (std::size_t stride = 2; stride <= m; stride *= 2) {
+            step([&] () {
+                for_each_node(id, stride, [&] (std::size_t right, std::size_t left) {
+                    tree_[right] += tree_[left];
+                });
+            });
+
+            b_.wait();
+        }
+
+        // the root's prefix is nothing at all - rather than clearing it (and waiting again), the first level of the...
+        // ...down-sweep just treats it as T{}
+        for (std::size_t stride = m; stride >= 2; stride /= 2) {
+            step([&] () {
+                for_each_node(id, stride, [&] (std::size_t right, std::size_t left) {
+                    T right_prefix = stride == m ? T{} : tree_[right];
+                    T left_sum = tree_[left];
+
+                    tree_[left] = right_prefix;
+                    tree_[right] = right_prefix + left_sum;
+                });
+            });
+
+            b_.wait();
+        }
+
+        step([&] () {
+            T running = tree_[id];
+            for ( ; block_first != block_last; ++block_first) {
+                running += *block_first;
+                *block_first = running;
+            }
+        });
+
+        if (error) { std::rethrow_exception(error); }
+    }
+
+private:
+    _RandomIt first_, last_;
+
+    std::size_t team_size_;
+    std::size_t block_size_;
+
+    std::vector<T> tree_;
+    barrier b_;
+
+    std::atomic<bool> failed_ = false;
+
+    // the nodes at this level sit every `stride` apart - deal them out round-robin across the team
+    template <typename Func>
+    void for_each_node(std::size_t id, std::size_t stride, Func f)
+    {
+        for (std::size_t right = (id + 1) * stride - 1; right < tree_.size(); right += team_size_ * stride) {
+            f(right, right - stride / 2);
+        }
+    }
+};
+} // namespace detail
+
+// every member of the team has to be running at once (they meet at each barrier), so the team is never bigger than...
+// ...the pool's workers plus us - and if we're already on one of those workers, we don't try to form a team at all
+template <typename _RandomIt>
+void partial_sum(_RandomIt __first, _RandomIt __last, thread_pool &pool = shared_pool()) {
+    std::size_t length = std::distance(__first, __last);
+    std::size_t team_size = std::min(pool.thread_count() + 1, length / min_block_size);
+
+    if (team_size < 2 || thread_pool::on_worker_thread()) {
+        std::partial_sum(__first, __last, __first);
+        return;
+    }
+
+    std::lock_guard lock(pool.team_mutex());
+
+    detail::blelloch_team<_RandomIt> team(__first, __last, team_size);
+
+    std::vector<std::future<void>> futures(team_size - 1);
+    for (std::size_t id = 0; id != team_size - 1; ++id) { futures[id] = pool.submit([&team, id] () { team(id); }); }
+
+    // everyone's finished with team (and our range) before we rethrow - if more than one of them threw, the first one wins
+    std::exception_ptr error;
+
+    try { team(team_size - 1); } catch (...) { error = std::current_exception(); }
+
+    for (auto &f : futures) {
+        try { f.get(); } catch (...) { if (!error) { error = std::current_exception(); } }
+    }
+
+    if (error) { std::rethrow_exception(error); }
+}
+} // namespace par (parallel)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+void printVec(const std::vector<int> &ivec) {
+    for (int i : ivec) {
+        std::cout << i << ' ';
+    } std::cout << '\n';
+}
+
+std::vector<long long> make_input(std::size_t n) {
+    std::vector<long long> v(n);
+    std::iota(v.begin(), v.end(), 0);
+    return v;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void bm_std_partial_sum(benchmark::State &state) {
+    auto input = make_input(state.range(0)), v = input;
+    for (auto _ : state) {
+        // a fresh copy every time - summing up the last iteration's sums again overflows long long (which is UB) in no time
+        state.PauseTiming();
+        std::copy(input.begin(), input.end(), v.begin());
+        state.ResumeTiming();
+
+        std::partial_sum(v.begin(), v.end(), v.begin());
+        benchmark::DoNotOptimize(v.data());
+    }
+} BENCHMARK(bm_std_partial_sum)->RangeMultiplier(16)->Range(1 << 8, 1 << 24)->UseRealTime();
+
+// a thread per element - anything past a few thousand takes forever
+static void bm_book_partial_sum(benchmark::State &state) {
+    auto input = make_input(state.range(0)), v = input;
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::copy(input.begin(), input.end(), v.begin());
+        state.ResumeTiming();
+
+        book::partial_sum(v.begin(), v.end());
+        benchmark::DoNotOptimize(v.data());
+    }
+} BENCHMARK(bm_book_partial_sum)->RangeMultiplier(4)->Range(1 << 6, 1 << 10)->UseRealTime();
+
+static void bm_par_partial_sum(benchmark::State &state) {
+    auto input = make_input(state.range(0)), v = input;
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::copy(input.begin(), input.end(), v.begin());
+        state.ResumeTiming();
+
+        par::partial_sum(v.begin(), v.end());
+        benchmark::DoNotOptimize(v.data());
+    }
+} BENCHMARK(bm_par_partial_sum)->RangeMultiplier(16)->Range(1 << 8, 1 << 24)->UseRealTime();
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int main(int argc, char **argv)
+{
+    std::vector<int> ivec  = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    std::vector<int> ivec2(ivec.begin(), ivec.end());
+    std::vector<int> ivec3(ivec.begin(), ivec.end());
+
+    std::cout << "ivec: "; printVec(ivec);
+
+    book::partial_sum(ivec.begin(), ivec.end());
+    std::cout << "book: "; printVec(ivec);
+
+    std::partial_sum(ivec2.begin(), ivec2.end(), ivec2.begin());
+    std::cout << "std:  "; printVec(ivec2);
+
+    par::partial_sum(ivec3.begin(), ivec3.end());
+    std::cout << "par:  "; printVec(ivec3);
+
+    // big enough to form a team - once on the shared pool, and once on a pool with an odd number of workers
+    thread_pool pool(6);
+
+    for (std::size_t n : { 100'000, 1'000'003 }) {
+        auto v1 = make_input(n), v2 = v1, v3 = v1;
+
+        std::partial_sum(v1.begin(), v1.end(), v1.begin());
+        par::partial_sum(v2.begin(), v2.end());
+        par::partial_sum(v3.begin(), v3.end(), pool);
+
+        std::cout << n << " longs: " << (v1 == v2 && v1 == v3 ? "match" : "DON'T match") << " std::partial_sum\n";
+    }
+
+    std::cout << '\n';
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//  OUTPUT - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// ivec: 1 2 3 4 5 6 7 8 9 
+// book: 1 3 6 10 15 21 28 36 45 
+// std:  1 3 6 10 15 21 28 36 45 
+// par:  1 3 6 10 15 21 28 36 45 
+// 100000 longs: match std::partial_sum
+// 1000003 longs: match std::partial_sum
+//
+// Run on (1 X 2100 MHz CPU )
+// CPU Caches:
+//   L1 Data 48 KiB (x1)
+//   L1 Instruction 32 KiB (x1)
+//   L2 Unified 2048 KiB (x1)
+//   L3 Unified 307200 KiB (x1)
+// Load Average: 0.84, 0.88, 1.08
+// --------------------------------------------------------------------------------
+// Benchmark                                      Time             CPU   Iterations
+// --------------------------------------------------------------------------------
+// bm_std_partial_sum/256/real_time             438 ns          437 ns      1785228
+// bm_std_partial_sum/4096/real_time           1813 ns         1789 ns       281673
+// bm_std_partial_sum/65536/real_time         25149 ns        24947 ns        24317
+// bm_std_partial_sum/1048576/real_time      446452 ns       442510 ns         1384
+// bm_std_partial_sum/16777216/real_time   21898957 ns     21751622 ns           34
+// bm_book_partial_sum/64/real_time         1647495 ns       867861 ns          408
+// bm_book_partial_sum/256/real_time        8371237 ns      3572312 ns           88
+// bm_book_partial_sum/1024/real_time      59806364 ns     18511075 ns           10
+// bm_par_partial_sum/256/real_time             515 ns          514 ns      1380230
+// bm_par_partial_sum/4096/real_time           1980 ns         1945 ns       262437
+// bm_par_partial_sum/65536/real_time         72649 ns        35675 ns         9706
+// bm_par_partial_sum/1048576/real_time     1368040 ns       678204 ns          616
+// bm_par_partial_sum/16777216/real_time   42461504 ns     21104410 ns           17
+// Program ended with exit code: 0
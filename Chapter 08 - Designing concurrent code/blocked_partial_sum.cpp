@@ -0,0 +1,343 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+class join_threads {
+public:
+    join_threads(std::vector<std::thread> &threads) : threads_(threads) { }
+
+    ~join_threads()
+    {
+        for (auto &t : threads_) {
+            if (t.joinable()) { t.join(); }
+        }
+    }
+
+private:
+    std::vector<std::thread> &threads_;
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// par_partial_sum.cpp as it was - each chunk waits on the previous chunk's future before it can fix itself up
+namespace book {
+template <typename _InputIterator>
+void partial_sum(_InputIterator __first, _InputIterator __last) {
+    typedef typename _InputIterator::value_type T;
+
+    struct process_chunk {
+        void operator() (_InputIterator begin, _InputIterator last, std::future<T> *prev_end_val, std::promise<T> *end_val)
+        {
+            try {
+                _InputIterator end = last;
+                ++end;
+
+                std::partial_sum(begin, end, begin);
+
+                if (prev_end_val) {
+                    const T &addend = prev_end_val->get();
+                    *last += addend;
+
+                    if (end_val) { end_val->set_value(*last); }
+
+                    std::for_each(begin, last, [addend] (T &item) {
+                        item += addend;
+                    });
+                }
+
+                else if (end_val) { end_val->set_value(*last); }
+            }
+
+            catch (...) {
+                if (end_val) {
+                    end_val->set_exception(std::current_exception());
+                } else {
+                    throw;
+                }
+            }
+        }
+    };
+
+    std::size_t length = std::distance(__first, __last);
+    if (!length) { return; }
+
+    std::size_t min_per_thread = 25;
+    std::size_t max_threads = (length + min_per_thread - 1) / min_per_thread;
+    std::size_t hw_threads = std::thread::hardware_concurrency();
+    std::size_t num_threads = std::min(hw_threads ? hw_threads : 2, max_threads);
+
+    std::size_t block_size = length / num_threads;
+
+    std::vector<std::thread> threads(num_threads - 1);
+    std::vector<std::promise<T>> end_vals(num_threads - 1);
+
+    std::vector<std::future<T>> prev_end_vals;
+    prev_end_vals.reserve(num_threads - 1);
+
+    join_threads joiner(threads);
+
+    _InputIterator block_start = __first;
+
+    for (std::size_t i = 0; i != num_threads - 1; ++i) {
+        _InputIterator block_last = block_start;
+        std::advance(block_last, block_size - 1);
+
+        threads[i] = std::thread(process_chunk(), block_start, block_last,
+                                 i ? &prev_end_vals[i - 1] : 0, &end_vals[i]);
+
+        block_start = block_last;
+        ++block_start;
+
+        prev_end_vals.push_back(end_vals[i].get_future());
+    }
+
+    _InputIterator final_element = block_start;
+
+    std::advance(final_element, std::distance(block_start, __last) - 1);
+
+    process_chunk() (block_start, final_element,
+                     num_threads > 1 ? &prev_end_vals.back() : 0, 0);
+}
+} // namespace book
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// two-pass blocked scan - nobody waits on anybody else's block
+//   1) reduce every block in parallel
+//   2) scan the (handful of) block totals on this thread to get each block's offset
+//   3) scan every block in parallel, starting from its offset
+// `op` only needs to be associative - blocks are combined strictly left-to-right, so it needn't commute
+namespace par {
+namespace detail {
+constexpr std::size_t min_per_block = 4096;
+
+inline std::size_t num_blocks_for(std::size_t length) {
+    std::size_t hw_threads = std::thread::hardware_concurrency();
+    std::size_t max_blocks = (length + min_per_block - 1) / min_per_block;
+    return std::min(hw_threads ? hw_threads : 2, max_blocks);
+}
+
+// runs f(b) for every block b in [0, num_blocks) - the last one on this thread - and rethrows the first exception
+template <typename Func>
+void for_each_block(std::size_t num_blocks, Func f) {
+    std::vector<std::future<void>> futures;
+    futures.reserve(num_blocks - 1);
+
+    for (std::size_t b = 0; b != num_blocks - 1; ++b) { futures.push_back(std::async(std::launch::async, f, b)); }
+
+    f(num_blocks - 1);
+
+    for (auto &fut : futures) { fut.get(); }
+}
+
+// `seed` is the value to the left of the block (empty for the very first block of an inclusive scan)
+template <bool Inclusive, typename _RandomIt, typename _OutputIt, typename _Tp, typename _BinaryOp>
+void scan_block(_RandomIt __first, _RandomIt __last, _OutputIt __d_first, const _Tp *__seed, _BinaryOp __op) {
+    if (__first == __last) { return; }
+
+    _Tp running = __seed ? *__seed : _Tp(*__first);
+
+    if (!__seed) { // first block of an inclusive scan - the first element is its own prefix
+        *__d_first = running;
+        ++__first, ++__d_first;
+    }
+
+    for ( ; __first != __last; ++__first, ++__d_first) {
+        if constexpr (Inclusive) {
+            running = __op(std::move(running), *__first);
+            *__d_first = running;
+        } else {
+            _Tp next = __op(running, *__first); // read before writing, so d_first == first still works
+            *__d_first = std::move(running);
+            running = std::move(next);
+        }
+    }
+}
+
+template <bool Inclusive, typename _RandomIt, typename _OutputIt, typename _Tp, typename _BinaryOp>
+_OutputIt scan(_RandomIt __first, _RandomIt __last, _OutputIt __d_first, const _Tp *__init, _BinaryOp __op) {
+    std::size_t length = std::distance(__first, __last);
+    if (!length) { return __d_first; }
+
+    std::size_t num_blocks = num_blocks_for(length);
+    std::size_t block_size = length / num_blocks;
+
+    auto block_begin = [&] (std::size_t b) { return __first + b * block_size; };
+    auto block_end   = [&] (std::size_t b) { return b == num_blocks - 1 ? __last : __first + (b + 1) * block_size; };
+
+    // pass 1 - block totals (the last block's total is never needed)
+    std::vector<_Tp> totals(num_blocks - 1);
+
+    if (num_blocks > 1) {
+        for_each_block(num_blocks - 1, [&] (std::size_t b) {
+            totals[b] = std::accumulate(std::next(block_begin(b)), block_end(b), _Tp(*block_begin(b)), __op);
+        });
+    }
+
+    // scan of the totals - exclusive: offsets[b] is everything left of block b, inclusive: everything left of block b + 1
+    std::vector<_Tp> offsets;
+    offsets.reserve(num_blocks);
+    if (__init) { offsets.push_back(*__init); }
+
+    for (std::size_t b = 0; b != num_blocks - 1; ++b) {
+        offsets.push_back(offsets.empty() ? totals[b] : __op(offsets.back(), totals[b]));
+    }
+
+    // pass 2 - every block scans itself from its offset (an inclusive scan's first block has none)
+    for_each_block(num_blocks, [&] (std::size_t b) {
+        const _Tp *seed = __init ? &offsets[b] : b ? &offsets[b - 1] : nullptr;
+        scan_block<Inclusive>(block_begin(b), block_end(b), __d_first + (block_begin(b) - __first), seed, __op);
+    });
+
+    return __d_first + length;
+}
+} // namespace detail
+
+template <typename _RandomIt, typename _OutputIt, typename _BinaryOp = std::plus<>>
+_OutputIt inclusive_scan(_RandomIt __first, _RandomIt __last, _OutputIt __d_first, _BinaryOp __op = _BinaryOp()) {
+    typedef typename std::iterator_traits<_RandomIt>::value_type T;
+    return detail::scan<true, _RandomIt, _OutputIt, T>(__first, __last, __d_first, nullptr, __op);
+}
+
+template <typename _RandomIt, typename _OutputIt, typename _Tp, typename _BinaryOp = std::plus<>>
+_OutputIt exclusive_scan(_RandomIt __first, _RandomIt __last, _OutputIt __d_first, _Tp __init, _BinaryOp __op = _BinaryOp()) {
+    return detail::scan<false>(__first, __last, __d_first, &__init, __op);
+}
+
+// same signature as the book's version - an in-place inclusive sum
+template <typename _RandomIt>
+void partial_sum(_RandomIt __first, _RandomIt __last) {
+    par::inclusive_scan(__first, __last, __first); // qualified, or ADL drags in std::inclusive_scan too
+}
+} // namespace par (parallel)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+template <typename T>
+void printVec(const std::vector<T> &vec) {
+    for (const auto &t : vec) {
+        std::cout << t << ' ';
+    } std::cout << '\n';
+}
+
+std::vector<long long> make_input(std::size_t n) {
+    std::vector<long long> v(n);
+    std::iota(v.begin(), v.end(), 0);
+    return v;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+static void bm_std_partial_sum(benchmark::State &state) {
+    auto input = make_input(state.range(0)), v = input;
+    for (auto _ : state) {
+        // a fresh copy every time - summing up the last iteration's sums again overflows long long (which is UB) in no time
+        state.PauseTiming();
+        std::copy(input.begin(), input.end(), v.begin());
+        state.ResumeTiming();
+
+        std::partial_sum(v.begin(), v.end(), v.begin());
+        benchmark::DoNotOptimize(v.data());
+    }
+} BENCHMARK(bm_std_partial_sum)->RangeMultiplier(16)->Range(1 << 12, 1 << 24)->UseRealTime();
+
+static void bm_book_partial_sum(benchmark::State &state) {
+    auto input = make_input(state.range(0)), v = input;
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::copy(input.begin(), input.end(), v.begin());
+        state.ResumeTiming();
+
+        book::partial_sum(v.begin(), v.end());
+        benchmark::DoNotOptimize(v.data());
+    }
+} BENCHMARK(bm_book_partial_sum)->RangeMultiplier(16)->Range(1 << 12, 1 << 24)->UseRealTime();
+
+static void bm_par_partial_sum(benchmark::State &state) {
+    auto input = make_input(state.range(0)), v = input;
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::copy(input.begin(), input.end(), v.begin());
+        state.ResumeTiming();
+
+        par::partial_sum(v.begin(), v.end());
+        benchmark::DoNotOptimize(v.data());
+    }
+} BENCHMARK(bm_par_partial_sum)->RangeMultiplier(16)->Range(1 << 12, 1 << 24)->UseRealTime();
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int main(int argc, char **argv)
+{
+    std::vector<int> ivec(10);
+    std::iota(ivec.begin(), ivec.end(), 0);
+
+    std::vector<int> inclusive(ivec.size()), exclusive(ivec.size());
+    par::inclusive_scan(ivec.begin(), ivec.end(), inclusive.begin());
+    par::exclusive_scan(ivec.begin(), ivec.end(), exclusive.begin(), 100);
+
+    std::cout << "ivec:      "; printVec(ivec);
+    std::cout << "inclusive: "; printVec(inclusive);
+    std::cout << "exclusive: "; printVec(exclusive);
+
+    // string concatenation is associative but not commutative - the blocks have to be stitched back in order
+    std::vector<std::string> svec(20000, "ab");
+    std::vector<std::string> sscan(svec.size()), sscan2(svec.size());
+    par::inclusive_scan(svec.begin(), svec.end(), sscan.begin());
+    std::inclusive_scan(svec.begin(), svec.end(), sscan2.begin());
+    std::cout << "strings:   " << (sscan == sscan2 ? "match" : "DON'T match") << " std::inclusive_scan\n";
+
+    // larger, in-place, against std::partial_sum
+    auto big = make_input(1 << 20), big2 = big;
+    par::partial_sum(big.begin(), big.end());
+    std::partial_sum(big2.begin(), big2.end(), big2.begin());
+    std::cout << "1M longs:  " << (big == big2 ? "match" : "DON'T match") << " std::partial_sum\n\n";
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//  OUTPUT - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// ivec:      0 1 2 3 4 5 6 7 8 9 
+// inclusive: 0 1 3 6 10 15 21 28 36 45 
+// exclusive: 100 100 101 103 106 110 115 121 128 136 
+// strings:   match std::inclusive_scan
+// 1M longs:  match std::partial_sum
+//
+// Run on (1 X 2100 MHz CPU )
+// CPU Caches:
+//   L1 Data 48 KiB (x1)
+//   L1 Instruction 32 KiB (x1)
+//   L2 Unified 2048 KiB (x1)
+//   L3 Unified 307200 KiB (x1)
+// Load Average: 0.75, 0.87, 1.09
+// ---------------------------------------------------------------------------------
+// Benchmark                                       Time             CPU   Iterations
+// ---------------------------------------------------------------------------------
+// bm_std_partial_sum/4096/real_time            1720 ns         1683 ns       417594
+// bm_std_partial_sum/65536/real_time          22532 ns        22376 ns        30887
+// bm_std_partial_sum/1048576/real_time       435822 ns       433339 ns         1673
+// bm_std_partial_sum/16777216/real_time    22175404 ns     21871979 ns           31
+// bm_book_partial_sum/4096/real_time           5108 ns         5048 ns       170337
+// bm_book_partial_sum/65536/real_time         25676 ns        25527 ns        25832
+// bm_book_partial_sum/1048576/real_time      440571 ns       435760 ns         1691
+// bm_book_partial_sum/16777216/real_time   21124312 ns     21010171 ns           31
+// bm_par_partial_sum/4096/real_time            5553 ns         5476 ns       100000
+// bm_par_partial_sum/65536/real_time          33248 ns        33141 ns        17612
+// bm_par_partial_sum/1048576/real_time       447204 ns       444179 ns         1415
+// bm_par_partial_sum/16777216/real_time    20807763 ns     20687498 ns           34
+// Program ended with exit code: 0
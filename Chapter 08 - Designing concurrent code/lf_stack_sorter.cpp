@@ -1,9 +1,18 @@
+#include <algorithm>
+#include <array>
 #include <memory>
 #include <atomic>
 #include <thread>
+#include <iterator>
 #include <list>
 #include <future>
 #include <iostream>
+#include <vector>
+#include <numeric>
+#include <random>
+#include <stop_token>
+#include <string>
+#include <utility>
 
 namespace lf {
 template <typename T>
@@ -20,7 +29,9 @@ public:
     std::shared_ptr<T> pop()
     {
         auto original_head = std::atomic_load(&head_);
-        while (original_head && !std::atomic_compare_exchange_weak(&head_, &original_head, original_head->next_));
+        
+        // next_ has to be read atomically too - whoever wins the pop clears it with atomic_store() below
+        while (original_head && !std::atomic_compare_exchange_weak(&head_, &original_head, std::atomic_load(&original_head->next_)));
     
         if (original_head) {
             std::atomic_store(&original_head->next_, {} );
@@ -47,61 +58,125 @@ private:
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+namespace par {
+// thrown out of a sort that's stopped before it finishes - the list it was given is left as it was
+struct operation_cancelled : std::exception {
+    const char* what() const noexcept override { return "operation cancelled"; }
+};
+} // namespace par
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
 template <typename T>
 class sorter {
 public:
-    sorter()
+    // idle threads sleep rather than spin now, so we can start them all up front - which also means threads_ is never...
+    // ...touched from inside do_sort() (where other sorting threads would be racing to read it)
+    // token stops the sort itself - the sorting threads have stop tokens of their own, for when the sorter's done with them
+    explicit sorter(std::stop_token token = {}) : token_(std::move(token)), wake_on_stop_(token_, wake_everyone{ this })
     {
-        max_threads_ = std::thread::hardware_concurrency() - 1;
-        still_data_.store(false);// = false;
+        // hardware_concurrency() is allowed to return 0 - which, minus one, would be a few billion threads
+        max_threads_ = std::max(1u, std::thread::hardware_concurrency()) - 1;
+        
+        try {
+            for (std::size_t i = 0; i != max_threads_; ++i) { threads_.push_back(std::jthread([this] (std::stop_token st) { sort_thread(st); } )); }
+        } catch (...) {
+            stop();
+            throw;
+        }
     }
     
-    ~sorter()
-    {
-        still_data_.store(true);// = true;
-        for (auto &t : threads_) { t.join(); }
-    }
+    ~sorter() { stop(); }
+    
+    // below this, std::list::sort on this thread beats pushing a chunk for someone else to pick up
+    static constexpr std::size_t inline_sort_size = 1024;
     
     std::list<T> do_sort(std::list<T> &chunk_data)
     {
-        if (chunk_data.empty()) { return chunk_data; }
-        
         std::list<T> result;
         
-        // like in chapter 4 - splice(a, b, c) -> transfer c from b before a
-        result.splice(result.begin(), chunk_data, chunk_data.begin());
-        
-        const T &partition_val = *(result.begin());
-        
-        // opted for "auto"
-        // split em up; less than pivot to the left; more than pivot to the right
-        auto divide_point = std::partition(chunk_data.begin(), chunk_data.end(), [&] (const T &val) {
-            return val < partition_val;
-        });
-        
-        chunk_to_sort new_lower_chunk;
-        
-        // splice(a, b, c, d) -> transfer range (c, d] from b to before a
-        new_lower_chunk.data_.splice(new_lower_chunk.data_.end(), chunk_data, chunk_data.begin(), divide_point);
-        
-        std::future<std::list<T>> new_lower = new_lower_chunk.promise_.get_future();
+        // the sides we've handed off, and where in result each one goes once it's back
+        std::vector<std::pair<std::future<std::list<T>>, typename std::list<T>::iterator>> pending;
         
-        chunks_.push(std::move(new_lower_chunk));
+        // ...and where whatever's left in chunk_data goes
+        auto hole = result.end();
         
-        if (threads_.size() < max_threads_) { threads_.push_back(std::thread([this] () { sort_thread(); } )); }
-        
-        std::list<T> new_higher(do_sort(chunk_data));
+        // anything under inline_sort_size is too small to be worth a chunk, a promise and a trip through the stack
+        while (chunk_data.size() >= inline_sort_size) {
+            // once per partition - a few hundred microseconds apart at most, even for a million elements
+            if (token_.stop_requested()) { throw par::operation_cancelled(); }
+            
+            std::list<T> equal;
+            
+            // like in chapter 4 - splice(a, b, c) -> transfer c from b before a
+            // the ninther rather than the first element, which is the worst pivot there is for sorted (or reversed) input
+            equal.splice(equal.begin(), chunk_data, ninther(chunk_data));
+            
+            const T &partition_val = *(equal.begin());
+            
+            // split em up three ways; less than pivot to the left; equal in the middle; more than pivot to the right
+            // with only two ways, every copy of the pivot goes round again - and with lots of duplicates, that's O(n) rounds
+            auto lower_end = std::partition(chunk_data.begin(), chunk_data.end(), [&] (const T &val) {
+                return val < partition_val;
+            });
+            
+            auto equal_end = std::partition(lower_end, chunk_data.end(), [&] (const T &val) {
+                return !(partition_val < val);
+            });
+            
+            std::list<T> new_lower;
+            
+            // splice(a, b, c, d) -> transfer range [c, d) from b to before a
+            new_lower.splice(new_lower.end(), chunk_data, chunk_data.begin(), lower_end);
+            equal.splice(equal.end(), chunk_data, lower_end, equal_end);
+            
+            // the middle's already sorted, and never goes round again
+            auto equal_begin = equal.begin();
+            result.splice(hole, equal);
+            
+            // chunk_data's the higher side now - only the smaller side is handed off (or sorted here), and we loop on the larger...
+            // ...rather than recursing on it, so however bad the pivots get, the stack doesn't grow
+            bool lower_is_smaller = new_lower.size() < chunk_data.size();
+            std::list<T> &smaller = lower_is_smaller ? new_lower : chunk_data;
+            auto smaller_pos = lower_is_smaller ? equal_begin : hole;
+            
+            if (smaller.size() < inline_sort_size) {
+                smaller.sort();
+                result.splice(smaller_pos, smaller);
+            } else {
+                chunk_to_sort smaller_chunk;
+                smaller_chunk.data_.splice(smaller_chunk.data_.end(), smaller);
+                
+                pending.emplace_back(smaller_chunk.promise_.get_future(), smaller_pos);
+                
+                chunks_.push(std::move(smaller_chunk));
+                
+                // one sleeper is enough - whoever wakes up takes the chunk
+                ++events_;
+                events_.notify_one();
+            }
+            
+            if (!lower_is_smaller) {
+                chunk_data.splice(chunk_data.end(), new_lower);
+                hole = equal_begin;
+            }
+        }
         
-        // splice (a, b) -> transfer all of b just before a
-        result.splice(result.end(), new_higher);
+        chunk_data.sort();
+        result.splice(hole, chunk_data);
         
-        while (new_lower.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
-            try_sort_chunk();
+        // newest first - they're the smallest, and the likeliest to still be on the stack for us to sort ourselves
+        for (auto p = pending.rbegin(); p != pending.rend(); ++p) {
+            // help out with other chunks until this one's done, and sleep if there's nothing to help with...
+            // ...or until we're stopped, in which case nobody wants what's left (and the chunk's promise outlives us)
+            wait_until([&] () { return token_.stop_requested() || p->first.wait_for(std::chrono::seconds(0)) == std::future_status::ready; });
+            
+            if (token_.stop_requested()) { throw par::operation_cancelled(); }
+            
+            // splice (a, b) -> transfer all of b just before a
+            result.splice(p->second, p->first.get());
         }
         
-        // splice (a, b) -> transfer all of b just before a
-        result.splice(result.begin(), new_lower.get());
-        
         return result;
     }
 private:
@@ -112,44 +187,113 @@ private:
     
     lf::stack<chunk_to_sort> chunks_;
     
-    std::vector<std::thread> threads_;
+    std::vector<std::jthread> threads_;
     
     std::size_t max_threads_;
     
-    std::atomic<bool> still_data_;
+    // bumped whenever a chunk is pushed or finished (or we're shutting down, or stopped) - sleepers wait for it to change
+    std::atomic<unsigned> events_{0};
     
-    void try_sort_chunk()
+    struct wake_everyone {
+        sorter *s_;
+        
+        void operator()() const
+        {
+            ++s_->events_;
+            s_->events_.notify_all();
+        }
+    };
+    
+    // a stop request has to wake up anyone asleep in wait_until(), or they'd never notice it
+    // declared after events_, as the callback runs straight away if token_'s already stopped
+    std::stop_token token_;
+    std::stop_callback<wake_everyone> wake_on_stop_;
+    
+    // Tukey's ninther - the median of the medians of three groups of three, spread evenly across the chunk
+    // on a list that means walking most of it, but the partition's about to walk all of it anyway
+    static typename std::list<T>::iterator ninther(std::list<T> &data)
+    {
+        std::size_t step = data.size() / 9;
+        
+        std::array<typename std::list<T>::iterator, 9> it;
+        it[0] = data.begin();
+        for (std::size_t i = 1; i != it.size(); ++i) { it[i] = std::next(it[i - 1], step); }
+        
+        auto median_of_three = [] (auto a, auto b, auto c) {
+            if (*a < *b) { return *b < *c ? b : (*a < *c ? c : a); }
+            return *a < *c ? a : (*b < *c ? c : b);
+        };
+        
+        return median_of_three(median_of_three(it[0], it[1], it[2]),
+                               median_of_three(it[3], it[4], it[5]),
+                               median_of_three(it[6], it[7], it[8]));
+    }
+    
+    bool try_sort_chunk()
     {
         auto chunk = chunks_.pop();
-        if (chunk) { sort_chunk(chunk); }
+        if (!chunk) { return false; }
+        
+        sort_chunk(chunk);
+        return true;
     }
     
     void sort_chunk(const std::shared_ptr<chunk_to_sort> &chunk)
     {
-        chunk->promise_.set_value(do_sort(chunk->data_));
+        try {
+            chunk->promise_.set_value(do_sort(chunk->data_));
+        } catch (...) {
+            chunk->promise_.set_exception(std::current_exception());
+        }
+        
+        // we don't know who's waiting on this one, so wake everybody
+        ++events_;
+        events_.notify_all();
     }
     
-    void sort_thread()
+    // sorts chunks until done() - and when there aren't any, blocks (no yield-spinning) until something changes
+    // events_ is read *before* the last look at the stack and done(), so a push or a finish in between can't be missed
+    template <typename Pred>
+    void wait_until(Pred done)
     {
-        while (!still_data_) {
-            try_sort_chunk();
-            std::this_thread::yield();
+        while (!done()) {
+            if (try_sort_chunk()) { continue; }
             
-            // yield allows the scheduler to "give way" to other threads
-            // "this should be used in a case where you are in a busy waiting state, like in a thread pool:"
-            // https://stackoverflow.com/a/11049210
+            unsigned seen = events_.load();
+            if (done() || try_sort_chunk()) { continue; }
+            
+            events_.wait(seen);
         }
     }
+    
+    void sort_thread(std::stop_token st)
+    {
+        wait_until([&] () { return st.stop_requested(); });
+    }
+    
+    void stop()
+    {
+        for (auto &t : threads_) { t.request_stop(); }
+        
+        // wake up anyone who's asleep waiting for work, so they see their stop request
+        wake_everyone{ this }();
+        
+        for (auto &t : threads_) { t.join(); }
+    }
 };
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 namespace par {
 template <typename T>
-std::list<T> quick_sort(std::list<T> input) {
-    if (input.empty()) { return input; }
+std::list<T> quick_sort(std::list<T> input, std::stop_token token = {}) {
+    // not worth starting (and stopping) the sorting threads for
+    if (input.size() < sorter<T>::inline_sort_size) {
+        input.sort();
+        return input;
+    }
     
-    return sorter<T>().do_sort(input);
+    return sorter<T>(std::move(token)).do_sort(input);
 }
 }
 
@@ -162,6 +306,23 @@ void print_list(const std::list<T> &tl) {
     } std::cout << '\n';
 }
 
+// sorts on another thread, and stops it 10ms in
+template <typename T>
+std::string cancel_sort(const std::list<T> &tl) {
+    std::stop_source stop;
+    auto sorting = std::async(std::launch::async, [&] () { return par::quick_sort(tl, stop.get_token()); });
+    
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    stop.request_stop();
+    
+    try {
+        sorting.get();
+        return "finished anyway";
+    } catch (const par::operation_cancelled &e) {
+        return e.what();
+    }
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 int main()
@@ -174,6 +335,28 @@ int main()
     std::cout << "after:  ";
     print_list(sorted);
     
+    // with the first element as the pivot, sorted / reversed input meant a million levels of recursion (and a crash)
+    std::list<int> ascending(1'000'000), descending;
+    std::iota(ascending.begin(), ascending.end(), 0);
+    descending.assign(ascending.rbegin(), ascending.rend());
+    
+    std::cout << "\nsorted:     " << (par::quick_sort(ascending) == ascending ? "ok" : "NOT ok") << '\n';
+    std::cout << "reversed:   " << (par::quick_sort(descending) == ascending ? "ok" : "NOT ok") << '\n';
+    
+    // ...and with a two-way partition, lots of duplicates meant the same (every copy of the pivot went round again)
+    std::mt19937 e(42);
+    std::list<int> duplicates(1'000'000), all_equal(1'000'000, 7);
+    for (auto &i : duplicates) { i = e() % 16; }
+    
+    auto expected = duplicates;
+    expected.sort();
+    
+    std::cout << "duplicates: " << (par::quick_sort(duplicates) == expected ? "ok" : "NOT ok") << '\n';
+    std::cout << "all equal:  " << (par::quick_sort(all_equal) == all_equal ? "ok" : "NOT ok") << '\n';
+    
+    // ...and a sort nobody wants any more - stopped part-way through, it throws rather than handing back half a job
+    std::cout << "stopped:    " << cancel_sort(duplicates) << '\n';
+    
     return 0;
 }
 
@@ -181,6 +364,12 @@ int main()
 //  OUTPUT - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-// before: 1 5 4 2 3 6 7 2 1 5 4 3 6 7
-// after:  1 1 2 2 3 3 4 4 5 5 6 6 7 7
+// before: 1 5 4 2 3 6 7 2 1 5 4 3 6 7 
+// after:  1 1 2 2 3 3 4 4 5 5 6 6 7 7 
+//
+// sorted:     ok
+// reversed:   ok
+// duplicates: ok
+// all equal:  ok
+// stopped:    operation cancelled
 // Program ended with exit code: 0
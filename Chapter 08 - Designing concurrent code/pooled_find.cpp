@@ -0,0 +1,632 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_X86 1
+#else
+#define SIMD_X86 0
+#endif
+
+namespace simd {
+// anything arithmetic whose == is a plain lane compare - 8 to 64-bit integers, float and double
+template <typename T>
+concept lane_type = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>
+                 && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+
+// only when we can hand the kernel a raw pointer and the value is already the element type (no conversions to second-guess)
+template <typename Iterator, typename T>
+concept searchable = std::contiguous_iterator<Iterator>
+                  && std::is_same_v<std::remove_cv_t<std::iter_value_t<Iterator>>, T>
+                  && lane_type<T>;
+
+#if SIMD_X86
+
+// SSE2 is part of the x86-64 baseline, so no runtime check - a 16-byte compare is plenty when we're bound by memory anyway
+template <typename T>
+__m128i splat(T value) {
+    if constexpr (std::is_same_v<T, float>)       { return _mm_castps_si128(_mm_set1_ps(value)); }
+    else if constexpr (std::is_same_v<T, double>) { return _mm_castpd_si128(_mm_set1_pd(value)); }
+    else if constexpr (sizeof(T) == 1)            { return _mm_set1_epi8(static_cast<char>(value)); }
+    else if constexpr (sizeof(T) == 2)            { return _mm_set1_epi16(static_cast<short>(value)); }
+    else if constexpr (sizeof(T) == 4)            { return _mm_set1_epi32(static_cast<int>(value)); }
+    else                                          { return _mm_set1_epi64x(static_cast<long long>(value)); }
+}
+
+// all-ones in every lane that matches - float / double compare as floats, so -0.0 == 0.0 and NaN never matches (same as ==)
+template <typename T>
+__m128i cmpeq(__m128i a, __m128i b) {
+    if constexpr (std::is_same_v<T, float>)       { return _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b))); }
+    else if constexpr (std::is_same_v<T, double>) { return _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b))); }
+    else if constexpr (sizeof(T) == 1)            { return _mm_cmpeq_epi8(a, b); }
+    else if constexpr (sizeof(T) == 2)            { return _mm_cmpeq_epi16(a, b); }
+    else if constexpr (sizeof(T) == 4)            { return _mm_cmpeq_epi32(a, b); }
+    else {
+        // no pcmpeqq until SSE4.1 - a 64-bit lane matches if both of its 32-bit halves do
+        __m128i halves = _mm_cmpeq_epi32(a, b);
+        return _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+    }
+}
+
+inline __m128i load(const void *p) { return _mm_loadu_si128(static_cast<const __m128i*>(p)); }
+
+// movemask gives one bit per *byte*, so the first set bit / sizeof(T) is the lane
+template <typename T>
+std::size_t first_lane(__m128i eq) {
+    return std::countr_zero(static_cast<unsigned>(_mm_movemask_epi8(eq))) / sizeof(T);
+}
+
+#endif // SIMD_X86
+
+// index of the first element equal to value, or n
+template <lane_type T>
+std::size_t find(const T *p, std::size_t n, T value) {
+    std::size_t i = 0;
+
+#if SIMD_X86
+    constexpr std::size_t lanes = sizeof(__m128i) / sizeof(T);
+    const __m128i needle = splat(value);
+
+    // four vectors (a cache line) per movemask - we only work out *which* one matched once we know one did
+    for ( ; i + 4 * lanes <= n; i += 4 * lanes) {
+        __m128i e0 = cmpeq<T>(load(p + i), needle);
+        __m128i e1 = cmpeq<T>(load(p + i + lanes), needle);
+        __m128i e2 = cmpeq<T>(load(p + i + 2 * lanes), needle);
+        __m128i e3 = cmpeq<T>(load(p + i + 3 * lanes), needle);
+
+        if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(e0, e1), _mm_or_si128(e2, e3)))) {
+            if (_mm_movemask_epi8(e0)) { return i + first_lane<T>(e0); }
+            if (_mm_movemask_epi8(e1)) { return i + lanes + first_lane<T>(e1); }
+            if (_mm_movemask_epi8(e2)) { return i + 2 * lanes + first_lane<T>(e2); }
+            return i + 3 * lanes + first_lane<T>(e3);
+        }
+    }
+
+    for ( ; i + lanes <= n; i += lanes) {
+        __m128i e = cmpeq<T>(load(p + i), needle);
+        if (_mm_movemask_epi8(e)) { return i + first_lane<T>(e); }
+    }
+#endif
+
+    for ( ; i != n; ++i) {
+        if (p[i] == value) { return i; }
+    }
+
+    return n;
+}
+} // namespace simd
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+namespace mt {
+template <typename T>
+class queue {
+public:
+    queue() : head_(std::make_unique<node>()), tail_(head_.get()) { }
+    
+    queue(const queue&) = delete;
+    queue& operator=(const queue&) = delete;
+    
+    std::shared_ptr<T> try_pop()
+    {
+        std::unique_ptr<node> old_head = try_pop_head();
+        return old_head ? old_head->data_ : std::shared_ptr<T>();
+    }
+    
+    bool try_pop(T &val)
+    {
+        std::unique_ptr<node> old_head = try_pop_head(val);
+        return old_head.get();
+    }
+    
+    std::shared_ptr<T> wait_and_pop()
+    {
+        std::unique_ptr<node> old_head = wait_pop_head();
+        return old_head->data_;
+    }
+    
+    void wait_and_pop(T &val)
+    {
+        std::unique_ptr<node> old_head = wait_pop_head(val);
+    }
+    
+    template <typename V>
+    void push(V &&val)
+    {
+        auto new_data = std::make_shared<T>(std::forward<V>(val));
+        auto p = std::make_unique<node>();
+        
+        {
+            std::lock_guard lock(tail_m);
+            tail_->data_ = new_data;
+            node *new_tail = p.get();
+            tail_->next_ = std::move(p);
+            tail_ = new_tail;
+        }
+        
+        cv.notify_one();
+    }
+    
+    bool empty() const
+    {
+        std::lock_guard lock(head_m);
+        return head_.get() == get_tail();
+    }
+    
+private:
+    struct node
+    {
+        std::shared_ptr<T> data_;
+        std::unique_ptr<node> next_;
+    };
+    
+    std::unique_ptr<node> pop_head()
+    {
+        std::unique_ptr<node> old_head = std::move(head_);
+        head_ = std::move(old_head->next_);
+        return old_head;
+    }
+    
+    std::unique_lock<std::mutex> wait_for_data()
+    {
+        std::unique_lock<std::mutex> lock(head_m);
+        cv.wait(lock, [&] () { return head_.get() != get_tail(); } );
+        return lock;
+    }
+    
+    std::unique_ptr<node> wait_pop_head()
+    {
+        std::unique_lock<std::mutex> lock(wait_for_data());
+        return pop_head();
+    }
+    
+    std::unique_ptr<node> wait_pop_head(T &val)
+    {
+        std::unique_lock<std::mutex> lock(wait_for_data());
+        val = std::move(*head_->data_);
+        return pop_head();;
+    }
+    
+    node* get_tail() const
+    {
+        std::lock_guard lock(tail_m);
+        return tail_;
+    }
+    
+    std::unique_ptr<node> try_pop_head()
+    {
+        std::lock_guard lock(head_m);
+        if (head_.get() == get_tail()) { return std::unique_ptr<node>(); }
+        return pop_head();
+    }
+    
+    std::unique_ptr<node> try_pop_head(T &val)
+    {
+        std::lock_guard lock(head_m);
+        if (head_.get() == get_tail()) { return std::unique_ptr<node>(); }
+        val = std::move(*head_->data_);
+        return pop_head();
+    }
+    
+    std::unique_ptr<node> head_;
+    node *tail_;
+    
+    mutable std::mutex head_m;
+    mutable std::mutex tail_m;
+    
+    std::condition_variable cv;
+};
+} // namespace mt (multi-threaded)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+class join_threads {
+public:
+    explicit join_threads(std::vector<std::thread> &threads) : threads_(threads) { }
+    
+    ~join_threads()
+    {
+        for (auto &t : threads_)
+            if (t.joinable()) { t.join(); }
+    }
+    
+private:
+    std::vector<std::thread> &threads_;
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+class function_wrapper {
+public:
+    function_wrapper() = default;
+    
+    function_wrapper(const function_wrapper&) = delete;
+    function_wrapper(function_wrapper&) = delete;
+    function_wrapper& operator=(const function_wrapper&) = delete;
+    
+    function_wrapper(function_wrapper &&other) noexcept : impl_(std::move(other.impl_)) { }
+    
+    function_wrapper& operator=(function_wrapper &&rhs) noexcept
+    {
+        impl_ = std::move(rhs.impl_);
+        return *this;
+    }
+    
+    template <typename Func>
+    // function_wrapper(Func &&f) : impl_(new impl_type<Func>(std::move(f))) { }
+    function_wrapper(Func &&f) noexcept : impl_(std::make_unique<impl_type<Func>>(std::move(f))) { }
+    
+    void operator() () { impl_->call(); }
+    
+    
+private:
+    struct impl_base {
+        // abstract base class
+        virtual void call() = 0;
+        virtual ~impl_base() { }
+    };
+    
+    std::unique_ptr<impl_base> impl_;
+    
+    template <typename Func>
+    struct impl_type : impl_base {
+        Func f_;
+        
+        impl_type(Func &&f) : f_(std::move(f)) { }
+        void call() { f_(); }
+    };
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// long-lived pool from pooled_accumulate.cpp - idle workers block in wait_and_pop(), so keeping one around is free
+class thread_pool {
+public:
+    explicit thread_pool(std::size_t thread_count = default_thread_count()) : done_(false), joiner_(threads_)
+    {
+        try {
+            for (std::size_t i = 0; i != thread_count; ++i)
+                threads_.push_back(std::thread(&thread_pool::worker_thread, this));
+        } catch (...) {
+            shutdown();
+            throw;
+        }
+    }
+    
+    ~thread_pool() { shutdown(); }
+    
+    template <typename Func>
+    std::future<std::invoke_result_t<Func&&>> submit(Func f)
+    {
+        typedef std::invoke_result_t<Func&&> T;
+        
+        std::packaged_task<T()> task(std::move(f));
+        std::future<T> result(task.get_future());
+        workq_.push(std::move(task));
+        
+        return result;
+    }
+    
+    // lets a thread that's waiting on the pool lend a hand - returns false if there was nothing to do
+    bool run_pending_task()
+    {
+        function_wrapper task;
+        if (!workq_.try_pop(task)) { return false; }
+        task();
+        return true;
+    }
+    
+    std::size_t thread_count() const { return threads_.size(); }
+    
+private:
+    std::atomic<bool> done_;
+    
+    mt::queue<function_wrapper> workq_;
+    
+    std::vector<std::thread> threads_;
+    join_threads joiner_;
+    
+    static std::size_t default_thread_count()
+    {
+        std::size_t hw_threads = std::thread::hardware_concurrency();
+        return hw_threads > 1 ? hw_threads - 1 : 1; // the caller makes up the numbers
+    }
+    
+    void worker_thread()
+    {
+        while (!done_) {
+            function_wrapper task;
+            workq_.wait_and_pop(task);
+            task();
+        }
+    }
+    
+    // one no-op per worker to wake it up so it can see done_
+    void shutdown()
+    {
+        done_ = true;
+        for (std::size_t i = 0; i != threads_.size(); ++i) { workq_.push([] () { }); }
+    }
+};
+
+// created on first use, joined at exit
+inline thread_pool& shared_pool() {
+    static thread_pool pool;
+    return pool;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// par_find.cpp as it was - fresh threads every call, `done` checked on every element, and whichever thread wins, wins
+namespace book {
+template <typename _InputIterator, typename _Tp>
+_InputIterator find(_InputIterator __first, _InputIterator __last, _Tp __value) {
+    struct find_element {
+        void operator() (_InputIterator __begin, _InputIterator __end, _Tp __match, std::promise<_InputIterator> *__result, std::atomic<bool> *__done)
+        {
+            try {
+                for ( ; __begin != __end && !__done->load(); ++__begin) {
+                    if (*__begin == __match) {
+                        __result->set_value(__begin);
+                        __done->store(true);
+                        return;
+                    }
+                }
+            } catch (...) {
+                try {
+                    __result->set_exception(std::current_exception());
+                    __done->store(true);
+                } catch (...) {
+                    // do nada
+                }
+            }
+        }
+    };
+    
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+    
+    std::size_t length = std::distance(__first, __last);
+    if (!length) { return __last; }
+    
+    // thread size boilerplate
+    std::size_t min_per_thread = 25;
+    std::size_t max_threads = (length + min_per_thread - 1) / min_per_thread;
+    std::size_t hw_threads = std::thread::hardware_concurrency();
+    std::size_t num_threads = std::min(hw_threads ? hw_threads : 2, max_threads);
+    
+    std::size_t block_size = length / num_threads;
+    
+    std::promise<_InputIterator> result;
+    std::atomic<bool> done(false);
+    
+    std::vector<std::thread> threads(num_threads - 1);
+    
+    {
+        join_threads joinder(threads);
+        
+        _InputIterator block_start = __first;
+        
+        for (auto &t : threads) {
+            _InputIterator block_end = block_start;
+            std::advance(block_end, block_size);
+            
+            t = std::thread(find_element(), block_start, block_end, __value, &result, &done);
+            
+            block_start = block_end;
+        }
+        
+        find_element()(block_start, __last, __value, &result, &done);
+    }
+    
+    if (!done.load()) { return __last; }
+    
+    return result.get_future().get();
+    
+}
+} // namespace book
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// workers claim chunks from the front of the range in order, and everyone keeps track of the lowest match so far...
+// ...a worker only gives up on a chunk once it's *past* that match, so anything to the left of it is always searched...
+// ...which makes the answer the same as std::find's, however the threads happen to be scheduled
+namespace par {
+// the unit of work handed out to a worker - big enough that claiming it (one fetch_add) is noise
+constexpr std::size_t chunk_size = 1 << 15;
+
+// how many elements we search between looks at `found` - one relaxed load per 4KB of ints rather than per element
+constexpr std::size_t check_interval = 1024;
+
+namespace detail {
+template <typename _RandomIt, typename _Tp>
+_RandomIt find_block(_RandomIt __first, _RandomIt __last, const _Tp &__value) {
+    if constexpr (simd::searchable<_RandomIt, _Tp>) {
+        return __first + simd::find(std::to_address(__first), __last - __first, __value);
+    } else {
+        return std::find(__first, __last, __value);
+    }
+}
+
+inline void fetch_min(std::atomic<std::size_t> &target, std::size_t value) {
+    std::size_t current = target.load(std::memory_order_relaxed);
+    while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed));
+}
+} // namespace detail
+
+template <typename _RandomIt, typename _Tp>
+_RandomIt find(_RandomIt __first, _RandomIt __last, const _Tp &__value) {
+    std::size_t length = std::distance(__first, __last);
+    std::size_t num_chunks = (length + chunk_size - 1) / chunk_size;
+
+    thread_pool &pool = shared_pool();
+    std::size_t num_searchers = std::min(pool.thread_count() + 1, num_chunks); // +1 for this thread
+
+    if (num_searchers < 2) { return detail::find_block(__first, __last, __value); }
+
+    std::atomic<std::size_t> next_chunk(0);
+    std::atomic<std::size_t> found(length); // lowest matching index so far - length means "nothing yet"
+
+    auto search = [&] () {
+        try {
+            for (std::size_t begin; (begin = next_chunk.fetch_add(1, std::memory_order_relaxed) * chunk_size) < length; ) {
+                std::size_t end = std::min(begin + chunk_size, length);
+
+                for (std::size_t pos = begin; pos < end; pos += check_interval) {
+                    // chunks are claimed in order, so once a match is to our left, so is everything we'd claim next
+                    if (found.load(std::memory_order_relaxed) < pos) { return; }
+
+                    std::size_t stop = std::min(pos + check_interval, end);
+                    std::size_t hit = detail::find_block(__first + pos, __first + stop, __value) - __first;
+
+                    if (hit != stop) {
+                        detail::fetch_min(found, hit);
+                        return;
+                    }
+                }
+            }
+        } catch (...) {
+            found.store(0, std::memory_order_relaxed); // nothing can beat 0, so everyone else stops at their next check
+            throw;
+        }
+    };
+
+    std::vector<std::future<void>> futures(num_searchers - 1);
+    for (auto &f : futures) { f = pool.submit(search); }
+
+    std::exception_ptr error;
+
+    try { search(); } catch (...) { error = std::current_exception(); }
+
+    // the searchers all reference our locals, so we wait for every one of them (helping if they're still queued) before leaving
+    for (auto &f : futures) {
+        while (f.wait_for(std::chrono::seconds(0)) != std::future_status::ready && pool.run_pending_task());
+        try { f.get(); } catch (...) { if (!error) { error = std::current_exception(); } }
+    }
+
+    if (error) { std::rethrow_exception(error); }
+
+    return __first + found.load(std::memory_order_relaxed);
+}
+} // namespace par (parallel)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// range(0) is the length, range(1) is where the match is as a percentage of the way in (100 = not there at all)
+template <typename Find>
+void bm_find(benchmark::State &state, Find find) {
+    std::vector<int> ivec(state.range(0));
+    std::iota(ivec.begin(), ivec.end(), 0);
+
+    int val = state.range(1) < 100 ? static_cast<int>(state.range(0) * state.range(1) / 100) : -1;
+
+    for (auto _ : state) {
+        auto it = find(ivec.begin(), ivec.end(), val);
+        benchmark::DoNotOptimize(it);
+    }
+}
+
+static void bm_std_find(benchmark::State &state) {
+    bm_find(state, [] (auto first, auto last, int val) { return std::find(first, last, val); });
+} BENCHMARK(bm_std_find)->ArgsProduct({ { 1 << 16, 1 << 22 }, { 1, 50, 100 } })->UseRealTime();
+
+static void bm_book_find(benchmark::State &state) {
+    bm_find(state, [] (auto first, auto last, int val) { return book::find(first, last, val); });
+} BENCHMARK(bm_book_find)->ArgsProduct({ { 1 << 16, 1 << 22 }, { 1, 50, 100 } })->UseRealTime();
+
+static void bm_par_find(benchmark::State &state) {
+    bm_find(state, [] (auto first, auto last, int val) { return par::find(first, last, val); });
+} BENCHMARK(bm_par_find)->ArgsProduct({ { 1 << 16, 1 << 22 }, { 1, 50, 100 } })->UseRealTime();
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int main(int argc, char **argv)
+{
+    // lots of copies of the value we're after - std::find (and so par::find) should always pick the first one
+    std::vector<int> ivec(1 << 20);
+    std::iota(ivec.begin(), ivec.end(), 0);
+    for (std::size_t i = 700'000; i < ivec.size(); i += 1'000) { ivec[i] = 42; }
+    ivec[42] = -1;
+
+    std::cout << "std::find: 42 found at index " << std::distance(ivec.begin(), std::find(ivec.begin(), ivec.end(), 42)) << '\n';
+
+    std::cout << "par::find: 42 found at index";
+    for (int run = 0; run != 5; ++run) { std::cout << ' ' << std::distance(ivec.begin(), par::find(ivec.begin(), ivec.end(), 42)); }
+    std::cout << '\n';
+
+    // a few other lane widths
+    std::vector<char> cvec(1 << 20, 'a');
+    cvec[123'457] = 'b';
+    std::vector<double> dvec(1 << 20, 1.0);
+    dvec[999'999] = -0.0;
+    std::vector<std::uint64_t> uvec(1 << 20, 0xFFFFFFFF);
+    uvec[654'321] = 0xFFFFFFFF00000000;
+
+    std::cout << "par::find: 'b' found at index " << std::distance(cvec.begin(), par::find(cvec.begin(), cvec.end(), 'b')) << '\n';
+    std::cout << "par::find: 0.0 found at index " << std::distance(dvec.begin(), par::find(dvec.begin(), dvec.end(), 0.0)) << '\n';
+    std::cout << "par::find: 0xFFFFFFFF00000000 found at index "
+              << std::distance(uvec.begin(), par::find(uvec.begin(), uvec.end(), std::uint64_t(0xFFFFFFFF00000000))) << '\n';
+    std::cout << "par::find: -2 found at index " << std::distance(ivec.begin(), par::find(ivec.begin(), ivec.end(), -2))
+              << " (size " << ivec.size() << ")\n\n";
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//  OUTPUT - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// std::find: 42 found at index 700000
+// par::find: 42 found at index 700000 700000 700000 700000 700000
+// par::find: 'b' found at index 123457
+// par::find: 0.0 found at index 999999
+// par::find: 0xFFFFFFFF00000000 found at index 654321
+// par::find: -2 found at index 1048576 (size 1048576)
+//
+// Run on (1 X 2100 MHz CPU )
+// CPU Caches:
+//   L1 Data 48 KiB (x1)
+//   L1 Instruction 32 KiB (x1)
+//   L2 Unified 2048 KiB (x1)
+//   L3 Unified 307200 KiB (x1)
+// Load Average: 0.30, 0.50, 0.43
+// -----------------------------------------------------------------------------
+// Benchmark                                   Time             CPU   Iterations
+// -----------------------------------------------------------------------------
+// bm_std_find/65536/1/real_time             155 ns          154 ns       461802
+// bm_std_find/4194304/1/real_time         12632 ns        10383 ns         7263
+// bm_std_find/65536/50/real_time           9335 ns         9272 ns         8010
+// bm_std_find/4194304/50/real_time       500589 ns       498029 ns          137
+// bm_std_find/65536/100/real_time         14766 ns        14766 ns         5008
+// bm_std_find/4194304/100/real_time      993080 ns       993112 ns           68
+// bm_book_find/65536/1/real_time           3830 ns         3820 ns        17922
+// bm_book_find/4194304/1/real_time       103732 ns       103642 ns          671
+// bm_book_find/65536/50/real_time         79746 ns        79699 ns          864
+// bm_book_find/4194304/50/real_time     4521289 ns      4521296 ns           14
+// bm_book_find/65536/100/real_time       159381 ns       156645 ns          445
+// bm_book_find/4194304/100/real_time    9989239 ns      9947279 ns            7
+// bm_par_find/65536/1/real_time            1002 ns          606 ns        79489
+// bm_par_find/4194304/1/real_time          5038 ns         2670 ns        10000
+// bm_par_find/65536/50/real_time           4389 ns         2431 ns        16886
+// bm_par_find/4194304/50/real_time       333158 ns       168432 ns          219
+// bm_par_find/65536/100/real_time          9514 ns         5116 ns         7106
+// bm_par_find/4194304/100/real_time      647586 ns       321183 ns          104
+// Program ended with exit code: 0
@@ -0,0 +1,553 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <execution>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mt {
+template <typename T>
+class queue {
+public:
+    queue() : head_(std::make_unique<node>()), tail_(head_.get()) { }
+    
+    queue(const queue&) = delete;
+    queue& operator=(const queue&) = delete;
+    
+    std::shared_ptr<T> try_pop()
+    {
+        std::unique_ptr<node> old_head = try_pop_head();
+        return old_head ? old_head->data_ : std::shared_ptr<T>();
+    }
+    
+    bool try_pop(T &val)
+    {
+        std::unique_ptr<node> old_head = try_pop_head(val);
+        return old_head.get();
+    }
+    
+    std::shared_ptr<T> wait_and_pop()
+    {
+        std::unique_ptr<node> old_head = wait_pop_head();
+        return old_head->data_;
+    }
+    
+    void wait_and_pop(T &val)
+    {
+        std::unique_ptr<node> old_head = wait_pop_head(val);
+    }
+    
+    template <typename V>
+    void push(V &&val)
+    {
+        auto new_data = std::make_shared<T>(std::forward<V>(val));
+        auto p = std::make_unique<node>();
+        
+        {
+            std::lock_guard lock(tail_m);
+            tail_->data_ = new_data;
+            node *new_tail = p.get();
+            tail_->next_ = std::move(p);
+            tail_ = new_tail;
+        }
+        
+        cv.notify_one();
+    }
+    
+    bool empty() const
+    {
+        std::lock_guard lock(head_m);
+        return head_.get() == get_tail();
+    }
+    
+private:
+    struct node
+    {
+        std::shared_ptr<T> data_;
+        std::unique_ptr<node> next_;
+    };
+    
+    std::unique_ptr<node> pop_head()
+    {
+        std::unique_ptr<node> old_head = std::move(head_);
+        head_ = std::move(old_head->next_);
+        return old_head;
+    }
+    
+    std::unique_lock<std::mutex> wait_for_data()
+    {
+        std::unique_lock<std::mutex> lock(head_m);
+        cv.wait(lock, [&] () { return head_.get() != get_tail(); } );
+        return lock;
+    }
+    
+    std::unique_ptr<node> wait_pop_head()
+    {
+        std::unique_lock<std::mutex> lock(wait_for_data());
+        return pop_head();
+    }
+    
+    std::unique_ptr<node> wait_pop_head(T &val)
+    {
+        std::unique_lock<std::mutex> lock(wait_for_data());
+        val = std::move(*head_->data_);
+        return pop_head();;
+    }
+    
+    node* get_tail() const
+    {
+        std::lock_guard lock(tail_m);
+        return tail_;
+    }
+    
+    std::unique_ptr<node> try_pop_head()
+    {
+        std::lock_guard lock(head_m);
+        if (head_.get() == get_tail()) { return std::unique_ptr<node>(); }
+        return pop_head();
+    }
+    
+    std::unique_ptr<node> try_pop_head(T &val)
+    {
+        std::lock_guard lock(head_m);
+        if (head_.get() == get_tail()) { return std::unique_ptr<node>(); }
+        val = std::move(*head_->data_);
+        return pop_head();
+    }
+    
+    std::unique_ptr<node> head_;
+    node *tail_;
+    
+    mutable std::mutex head_m;
+    mutable std::mutex tail_m;
+    
+    std::condition_variable cv;
+};
+} // namespace mt (multi-threaded)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+class join_threads {
+public:
+    explicit join_threads(std::vector<std::thread> &threads) : threads_(threads) { }
+    
+    ~join_threads()
+    {
+        for (auto &t : threads_)
+            if (t.joinable()) { t.join(); }
+    }
+    
+private:
+    std::vector<std::thread> &threads_;
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+class function_wrapper {
+public:
+    function_wrapper() = default;
+    
+    function_wrapper(const function_wrapper&) = delete;
+    function_wrapper(function_wrapper&) = delete;
+    function_wrapper& operator=(const function_wrapper&) = delete;
+    
+    function_wrapper(function_wrapper &&other) noexcept : impl_(std::move(other.impl_)) { }
+    
+    function_wrapper& operator=(function_wrapper &&rhs) noexcept
+    {
+        impl_ = std::move(rhs.impl_);
+        return *this;
+    }
+    
+    template <typename Func>
+    // function_wrapper(Func &&f) : impl_(new impl_type<Func>(std::move(f))) { }
+    function_wrapper(Func &&f) noexcept : impl_(std::make_unique<impl_type<Func>>(std::move(f))) { }
+    
+    void operator() () { impl_->call(); }
+    
+    
+private:
+    struct impl_base {
+        // abstract base class
+        virtual void call() = 0;
+        virtual ~impl_base() { }
+    };
+    
+    std::unique_ptr<impl_base> impl_;
+    
+    template <typename Func>
+    struct impl_type : impl_base {
+        Func f_;
+        
+        impl_type(Func &&f) : f_(std::move(f)) { }
+        void call() { f_(); }
+    };
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// long-lived pool from pooled_accumulate.cpp - idle workers block in wait_and_pop(), so keeping one around is free
+class thread_pool {
+public:
+    explicit thread_pool(std::size_t thread_count = default_thread_count()) : done_(false), joiner_(threads_)
+    {
+        try {
+            for (std::size_t i = 0; i != thread_count; ++i)
+                threads_.push_back(std::thread(&thread_pool::worker_thread, this));
+        } catch (...) {
+            shutdown();
+            throw;
+        }
+    }
+    
+    ~thread_pool() { shutdown(); }
+    
+    template <typename Func>
+    std::future<std::invoke_result_t<Func&&>> submit(Func f)
+    {
+        typedef std::invoke_result_t<Func&&> T;
+        
+        std::packaged_task<T()> task(std::move(f));
+        std::future<T> result(task.get_future());
+        workq_.push(std::move(task));
+        
+        return result;
+    }
+    
+    // lets a thread that's waiting on the pool lend a hand - returns false if there was nothing to do
+    bool run_pending_task()
+    {
+        function_wrapper task;
+        if (!workq_.try_pop(task)) { return false; }
+        task();
+        return true;
+    }
+    
+    std::size_t thread_count() const { return threads_.size(); }
+    
+private:
+    std::atomic<bool> done_;
+    
+    mt::queue<function_wrapper> workq_;
+    
+    std::vector<std::thread> threads_;
+    join_threads joiner_;
+    
+    static std::size_t default_thread_count()
+    {
+        std::size_t hw_threads = std::thread::hardware_concurrency();
+        return hw_threads > 1 ? hw_threads - 1 : 1; // the caller makes up the numbers
+    }
+    
+    void worker_thread()
+    {
+        while (!done_) {
+            function_wrapper task;
+            workq_.wait_and_pop(task);
+            task();
+        }
+    }
+    
+    // one no-op per worker to wake it up so it can see done_
+    void shutdown()
+    {
+        done_ = true;
+        for (std::size_t i = 0; i != threads_.size(); ++i) { workq_.push([] () { }); }
+    }
+};
+
+// created on first use, joined at exit
+inline thread_pool& shared_pool() {
+    static thread_pool pool;
+    return pool;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+namespace par {
+namespace detail {
+// runs f(i) for every i in [0, n) on the pool (the last one on this thread), helping out while we wait...
+// ...and rethrows the first exception, but only once every task is finished (they all reference our locals)
+template <typename Func>
+void for_each_index(thread_pool &pool, std::size_t n, Func f) {
+    if (!n) { return; }
+
+    std::vector<std::future<void>> futures(n - 1);
+    for (std::size_t i = 0; i != n - 1; ++i) { futures[i] = pool.submit([&f, i] () { f(i); }); }
+
+    std::exception_ptr error;
+
+    try { f(n - 1); } catch (...) { error = std::current_exception(); }
+
+    for (auto &fut : futures) {
+        while (fut.wait_for(std::chrono::seconds(0)) != std::future_status::ready && pool.run_pending_task());
+        try { fut.get(); } catch (...) { if (!error) { error = std::current_exception(); } }
+    }
+
+    if (error) { std::rethrow_exception(error); }
+}
+} // namespace detail
+
+// below this, std::sort on one thread wins
+constexpr std::size_t min_parallel_sort = 1 << 15;
+
+// buckets per thread - more buckets balance better, but make every element's binary search a little longer
+constexpr std::size_t buckets_per_thread = 8;
+
+// sample this many elements per splitter, so the buckets come out roughly the same size
+constexpr std::size_t oversampling = 16;
+
+// samplesort - pick splitters from a sorted sample, then every thread...
+//   1) counts how many of its block's elements fall into each bucket
+//   2) (after a prefix sum of the counts) moves its elements into their buckets in a scratch buffer
+//   3) sorts whole buckets and moves them back
+// every element that's equal to a splitter goes into its own "equality" bucket, which is already sorted - so lots of...
+// ...duplicates can't pile up in one bucket and leave a single thread to do all the work
+// N.B. needs the value type to be default-constructible (for the scratch buffer)
+template <typename _RandomIt, typename _Compare = std::less<>>
+void sort(_RandomIt __first, _RandomIt __last, _Compare __comp = _Compare()) {
+    typedef typename std::iterator_traits<_RandomIt>::value_type T;
+
+    std::size_t length = std::distance(__first, __last);
+
+    thread_pool &pool = shared_pool();
+    std::size_t num_threads = pool.thread_count() + 1; // +1 for this thread
+
+    if (length < min_parallel_sort) {
+        std::sort(__first, __last, __comp);
+        return;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+    // splitters - a fixed seed, so the same input always splits the same way
+    // one less than a power of two of them, so they make a complete binary tree for bucket_of()
+    std::size_t num_splitters = std::bit_ceil(num_threads * buckets_per_thread) - 1;
+
+    std::vector<T> sample;
+    sample.reserve((num_splitters + 1) * oversampling);
+
+    std::minstd_rand e(length);
+    std::uniform_int_distribution<std::size_t> u(0, length - 1);
+    for (std::size_t i = 0; i != sample.capacity(); ++i) { sample.push_back(*(__first + u(e))); }
+
+    std::sort(sample.begin(), sample.end(), __comp);
+
+    std::vector<T> splitters;
+    splitters.reserve(num_splitters);
+    for (std::size_t i = 1; i <= num_splitters; ++i) { splitters.push_back(sample[i * oversampling]); }
+
+    // the same splitters laid out breadth-first (tree[1] is the root, tree[j]'s children are tree[2j] and tree[2j + 1])...
+    // ...so finding a bucket is log2 steps of "go left or right" with no branch to mispredict
+    std::vector<T> tree(num_splitters + 1);
+
+    for (std::size_t level = num_splitters + 1, step = 1; level > 1; level /= 2, step *= 2) {
+        for (std::size_t j = level / 2, i = step - 1; j != level; ++j, i += 2 * step) { tree[j] = splitters[i]; }
+    }
+
+    // splitter j has an equality bucket 2j + 1, with the elements strictly between splitters j - 1 and j in bucket 2j
+    std::size_t num_buckets = 2 * num_splitters + 1;
+
+    auto bucket_of = [&] (const T &val) {
+        std::size_t j = 1;
+        while (j <= num_splitters) { j = 2 * j + !__comp(val, tree[j]); }
+        j -= num_splitters + 1; // how many splitters are <= val
+
+        return j && !__comp(splitters[j - 1], val) ? 2 * j - 1 : 2 * j;
+    };
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+    std::size_t block_size = length / num_threads;
+
+    auto block_begin = [&] (std::size_t b) { return __first + b * block_size; };
+    auto block_end   = [&] (std::size_t b) { return b == num_threads - 1 ? __last : __first + (b + 1) * block_size; };
+
+    // counts[b * num_buckets + k] - each thread only writes its own row
+    std::vector<std::size_t> counts(num_threads * num_buckets);
+
+    // remember every element's bucket, so the scatter doesn't have to work it out again
+    std::vector<std::uint16_t> oracle(length);
+
+    detail::for_each_index(pool, num_threads, [&] (std::size_t b) {
+        std::size_t *row = &counts[b * num_buckets];
+
+        for (std::size_t i = block_begin(b) - __first, end = block_end(b) - __first; i != end; ++i) {
+            oracle[i] = static_cast<std::uint16_t>(bucket_of(*(__first + i)));
+            ++row[oracle[i]];
+        }
+    });
+
+    // bucket-major prefix sum - block b's elements for bucket k go after every earlier block's elements for bucket k
+    std::vector<std::size_t> bucket_start(num_buckets + 1);
+    std::size_t offset = 0;
+
+    for (std::size_t k = 0; k != num_buckets; ++k) {
+        bucket_start[k] = offset;
+
+        for (std::size_t b = 0; b != num_threads; ++b) {
+            std::size_t count = counts[b * num_buckets + k];
+            counts[b * num_buckets + k] = offset;
+            offset += count;
+        }
+    }
+
+    bucket_start[num_buckets] = length;
+
+    std::vector<T> buffer(length);
+
+    detail::for_each_index(pool, num_threads, [&] (std::size_t b) {
+        std::size_t *row = &counts[b * num_buckets];
+
+        for (std::size_t i = block_begin(b) - __first, end = block_end(b) - __first; i != end; ++i) {
+            buffer[row[oracle[i]]++] = std::move(*(__first + i));
+        }
+    });
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+    // one task per bucket - there are a few per thread, so an unlucky big one doesn't hold everybody up
+    detail::for_each_index(pool, num_buckets, [&] (std::size_t k) {
+        auto first = buffer.begin() + bucket_start[k], last = buffer.begin() + bucket_start[k + 1];
+
+        if (k % 2 == 0) { std::sort(first, last, __comp); } // odd buckets are all equal to their splitter
+        std::move(first, last, __first + bucket_start[k]);
+    });
+}
+} // namespace par (parallel)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+enum class input { random, sorted, reversed, few_unique };
+
+std::vector<int> make_input(std::size_t n, input kind) {
+    std::vector<int> ivec(n);
+
+    std::mt19937 e(42);
+    std::uniform_int_distribution<int> u;
+    for (auto &i : ivec) { i = u(e); }
+
+    switch (kind) {
+        case input::random:     break;
+        case input::sorted:     std::sort(ivec.begin(), ivec.end()); break;
+        case input::reversed:   std::sort(ivec.begin(), ivec.end(), std::greater<>()); break;
+        case input::few_unique: for (auto &i : ivec) { i %= 16; } break;
+    }
+
+    return ivec;
+}
+
+// range(0) is the length, range(1) is the kind of input
+template <typename Sort>
+void bm_sort(benchmark::State &state, Sort sort) {
+    auto input = make_input(state.range(0), static_cast<enum input>(state.range(1)));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto ivec = input;
+        state.ResumeTiming();
+
+        sort(ivec.begin(), ivec.end());
+        benchmark::DoNotOptimize(ivec.data());
+    }
+}
+
+static void bm_std_sort(benchmark::State &state) {
+    bm_sort(state, [] (auto first, auto last) { std::sort(first, last); });
+} BENCHMARK(bm_std_sort)->ArgsProduct({ { 1 << 16, 1 << 22 }, { 0, 1, 2, 3 } })->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void bm_std_par_sort(benchmark::State &state) {
+    bm_sort(state, [] (auto first, auto last) { std::sort(std::execution::par, first, last); });
+} BENCHMARK(bm_std_par_sort)->ArgsProduct({ { 1 << 16, 1 << 22 }, { 0, 1, 2, 3 } })->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void bm_par_sort(benchmark::State &state) {
+    bm_sort(state, [] (auto first, auto last) { par::sort(first, last); });
+} BENCHMARK(bm_par_sort)->ArgsProduct({ { 1 << 16, 1 << 22 }, { 0, 1, 2, 3 } })->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int main(int argc, char **argv)
+{
+    for (auto kind : { input::random, input::sorted, input::reversed, input::few_unique }) {
+        auto ivec = make_input(1'000'003, kind), ivec2 = ivec;
+
+        par::sort(ivec.begin(), ivec.end());
+        std::sort(ivec2.begin(), ivec2.end());
+
+        std::cout << "input " << static_cast<int>(kind) << ": par::sort " << (ivec == ivec2 ? "matches" : "DOESN'T match") << " std::sort\n";
+    }
+
+    // a custom comparison, and a type that's expensive to copy
+    std::vector<std::string> svec(100'000);
+    for (std::size_t i = 0; i != svec.size(); ++i) { svec[i] = std::to_string(i * 7919 % svec.size()); }
+    auto svec2 = svec;
+
+    par::sort(svec.begin(), svec.end(), std::greater<>());
+    std::sort(svec2.begin(), svec2.end(), std::greater<>());
+    std::cout << "strings: par::sort " << (svec == svec2 ? "matches" : "DOESN'T match") << " std::sort\n\n";
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//  OUTPUT - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// input 0: par::sort matches std::sort
+// input 1: par::sort matches std::sort
+// input 2: par::sort matches std::sort
+// input 3: par::sort matches std::sort
+// strings: par::sort matches std::sort
+//
+// Run on (1 X 2100 MHz CPU )
+// CPU Caches:
+//   L1 Data 48 KiB (x1)
+//   L1 Instruction 32 KiB (x1)
+//   L2 Unified 2048 KiB (x1)
+//   L3 Unified 307200 KiB (x1)
+// Load Average: 0.61, 0.50, 0.44
+// ------------------------------------------------------------------------------
+// Benchmark                                    Time             CPU   Iterations
+// ------------------------------------------------------------------------------
+// bm_std_sort/65536/0/real_time             3.92 ms         3.90 ms           16
+// bm_std_sort/4194304/0/real_time            375 ms          373 ms            1
+// bm_std_sort/65536/1/real_time            0.580 ms        0.580 ms          109
+// bm_std_sort/4194304/1/real_time           59.5 ms         53.4 ms            1
+// bm_std_sort/65536/2/real_time            0.425 ms        0.397 ms          179
+// bm_std_sort/4194304/2/real_time           35.2 ms         35.2 ms            2
+// bm_std_sort/65536/3/real_time             1.54 ms         1.54 ms           38
+// bm_std_sort/4194304/3/real_time            104 ms          104 ms            1
+// bm_std_par_sort/65536/0/real_time         4.95 ms         4.95 ms           12
+// bm_std_par_sort/4194304/0/real_time        470 ms          468 ms            1
+// bm_std_par_sort/65536/1/real_time        0.344 ms        0.320 ms          219
+// bm_std_par_sort/4194304/1/real_time       19.8 ms         19.8 ms            3
+// bm_std_par_sort/65536/2/real_time        0.582 ms        0.553 ms          118
+// bm_std_par_sort/4194304/2/real_time       51.6 ms         51.6 ms            1
+// bm_std_par_sort/65536/3/real_time         2.21 ms         2.19 ms           33
+// bm_std_par_sort/4194304/3/real_time        157 ms          157 ms            1
+// bm_par_sort/65536/0/real_time             3.62 ms         1.79 ms           18
+// bm_par_sort/4194304/0/real_time            338 ms          171 ms            1
+// bm_par_sort/65536/1/real_time            0.929 ms        0.547 ms           76
+// bm_par_sort/4194304/1/real_time           97.3 ms         55.0 ms            1
+// bm_par_sort/65536/2/real_time            0.825 ms        0.488 ms           79
+// bm_par_sort/4194304/2/real_time           81.1 ms         45.2 ms            1
+// bm_par_sort/65536/3/real_time            0.571 ms        0.367 ms          127
+// bm_par_sort/4194304/3/real_time           57.8 ms         36.7 ms            1
+// Program ended with exit code: 0
@@ -0,0 +1,793 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <stack>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// the sorters from ts_stack_sorter.cpp and lf_stack_sorter.cpp, copied as they are (without their main()s) - each in...
+// ...a namespace of its own, as they both have a sorter<T> and a par::quick_sort. keep them in step with the listings
+namespace ts_stack_sorter {
+namespace ts {
+template <typename T>
+class stack {
+public:
+    stack() { }
+    
+    stack(const stack &o)
+    {
+        std::lock_guard lock(m_);
+        data_ = o.data_;
+    }
+    
+    stack& operator=(const stack&) = delete;
+    
+    template <typename V>
+    void push(V &&val)
+    {
+        std::lock_guard lock(m_);
+        data_.push(std::forward<V>(val));
+    }
+    
+    std::shared_ptr<T> pop()
+    {
+        std::lock_guard lock(m_);
+        if (data_.empty()) { return std::shared_ptr<T>(); }
+        
+        // EXTREMELY IMPORTANT TO USE STD::MOVE
+        // "No matching constructor for 'construct_at'", otherwise
+        auto result = std::make_shared<T>(std::move(data_.top()));
+        data_.pop();
+        return result;
+    }
+    
+    bool empty() const
+    {
+        std::lock_guard lock(m_);
+        return data_.empty();
+    }
+private:
+    std::stack<T> data_;
+    mutable std::mutex m_;
+};
+} // namespace ts (threadsafe)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+namespace par {
+// thrown out of a sort that's stopped before it finishes - the list it was given is left as it was
+struct operation_cancelled : std::exception {
+    const char* what() const noexcept override { return "operation cancelled"; }
+};
+} // namespace par
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+template <typename T>
+class sorter {
+public:
+    // token stops the sort itself - the sorting threads have stop tokens of their own, for when the sorter's done with them
+    explicit sorter(std::stop_token token = {}) : token_(std::move(token))
+    {
+        max_threads_ = std::thread::hardware_concurrency() - 1;
+    }
+    
+    ~sorter()
+    {
+        for (auto &t : threads_) { t.request_stop(); }
+        for (auto &t : threads_) { t.join(); }
+    }
+    
+    std::list<T> do_sort(std::list<T> &chunk_data)
+    {
+        std::list<T> result;
+        
+        // the sides we've handed off, and where in result each one goes once it's back
+        std::vector<std::pair<std::future<std::list<T>>, typename std::list<T>::iterator>> pending;
+        
+        // ...and where whatever's left in chunk_data goes
+        auto hole = result.end();
+        
+        // anything under inline_sort_size is too small to be worth a chunk, a promise and a trip through the stack
+        while (chunk_data.size() >= inline_sort_size) {
+            // once per partition - a few hundred microseconds apart at most, even for a million elements
+            if (token_.stop_requested()) { throw par::operation_cancelled(); }
+            
+            std::list<T> equal;
+            
+            // like in chapter 4 - splice(a, b, c) -> transfer c from b before a
+            // the ninther rather than the first element, which is the worst pivot there is for sorted (or reversed) input
+            equal.splice(equal.begin(), chunk_data, ninther(chunk_data));
+            
+            const T &partition_val = *(equal.begin());
+            
+            // split em up three ways; less than pivot to the left; equal in the middle; more than pivot to the right
+            // with only two ways, every copy of the pivot goes round again - and with lots of duplicates, that's O(n) rounds
+            auto lower_end = std::partition(chunk_data.begin(), chunk_data.end(), [&] (const T &val) {
+                return val < partition_val;
+            });
+            
+            auto equal_end = std::partition(lower_end, chunk_data.end(), [&] (const T &val) {
+                return !(partition_val < val);
+            });
+            
+            std::list<T> new_lower;
+            
+            // splice(a, b, c, d) -> transfer range [c, d) from b to before a
+            new_lower.splice(new_lower.end(), chunk_data, chunk_data.begin(), lower_end);
+            equal.splice(equal.end(), chunk_data, lower_end, equal_end);
+            
+            // the middle's already sorted, and never goes round again
+            auto equal_begin = equal.begin();
+            result.splice(hole, equal);
+            
+            // chunk_data's the higher side now - only the smaller side is handed off (or sorted here), and we loop on the larger...
+            // ...rather than recursing on it, so however bad the pivots get, the stack doesn't grow
+            bool lower_is_smaller = new_lower.size() < chunk_data.size();
+            std::list<T> &smaller = lower_is_smaller ? new_lower : chunk_data;
+            auto smaller_pos = lower_is_smaller ? equal_begin : hole;
+            
+            if (smaller.size() < inline_sort_size) {
+                smaller.sort();
+                result.splice(smaller_pos, smaller);
+            } else {
+                chunk_to_sort smaller_chunk;
+                smaller_chunk.data_.splice(smaller_chunk.data_.end(), smaller);
+                
+                pending.emplace_back(smaller_chunk.promise_.get_future(), smaller_pos);
+                
+                chunks_.push(std::move(smaller_chunk));
+                
+                if (threads_.size() < max_threads_) { threads_.push_back(std::jthread([this] (std::stop_token st) { sort_thread(st); } )); }
+            }
+            
+            if (!lower_is_smaller) {
+                chunk_data.splice(chunk_data.end(), new_lower);
+                hole = equal_begin;
+            }
+        }
+        
+        chunk_data.sort();
+        result.splice(hole, chunk_data);
+        
+        // newest first - they're the smallest, and the likeliest to still be on the stack for us to sort ourselves
+        for (auto p = pending.rbegin(); p != pending.rend(); ++p) {
+            // once we're stopped, nobody wants what's left (and the chunk's promise outlives us)
+            while (p->first.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                if (token_.stop_requested()) { throw par::operation_cancelled(); }
+                try_sort_chunk();
+            }
+            
+            // splice (a, b) -> transfer all of b just before a
+            result.splice(p->second, p->first.get());
+        }
+        
+        return result;
+    }
+private:
+    // below this, std::list::sort on this thread beats pushing a chunk for someone else to pick up
+    static constexpr std::size_t inline_sort_size = 1024;
+    
+    struct chunk_to_sort {
+        std::list<T> data_;
+        std::promise<std::list<T>> promise_;
+    };
+    
+    ts::stack<chunk_to_sort> chunks_;
+    
+    std::stop_token token_;
+    
+    std::vector<std::jthread> threads_;
+    
+    std::size_t max_threads_;
+    
+    // Tukey's ninther - the median of the medians of three groups of three, spread evenly across the chunk
+    // on a list that means walking most of it, but the partition's about to walk all of it anyway
+    static typename std::list<T>::iterator ninther(std::list<T> &data)
+    {
+        std::size_t step = data.size() / 9;
+        
+        std::array<typename std::list<T>::iterator, 9> it;
+        it[0] = data.begin();
+        for (std::size_t i = 1; i != it.size(); ++i) { it[i] = std::next(it[i - 1], step); }
+        
+        auto median_of_three = [] (auto a, auto b, auto c) {
+            if (*a < *b) { return *b < *c ? b : (*a < *c ? c : a); }
+            return *a < *c ? a : (*b < *c ? c : b);
+        };
+        
+        return median_of_three(median_of_three(it[0], it[1], it[2]),
+                               median_of_three(it[3], it[4], it[5]),
+                               median_of_three(it[6], it[7], it[8]));
+    }
+    
+    void try_sort_chunk()
+    {
+        auto chunk = chunks_.pop();
+        if (chunk) { sort_chunk(chunk); }
+    }
+    
+    void sort_chunk(const std::shared_ptr<chunk_to_sort> &chunk)
+    {
+        try {
+            chunk->promise_.set_value(do_sort(chunk->data_));
+        } catch (...) {
+            chunk->promise_.set_exception(std::current_exception());
+        }
+    }
+    
+    void sort_thread(std::stop_token st)
+    {
+        while (!st.stop_requested()) {
+            try_sort_chunk();
+            std::this_thread::yield();
+            
+            // yield allows the scheduler to "give way" to other threads
+            // "this should be used in a case where you are in a busy waiting state, like in a thread pool:"
+            // https://stackoverflow.com/a/11049210
+        }
+    }
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+namespace par {
+template <typename T>
+std::list<T> quick_sort(std::list<T> input, std::stop_token token = {}) {
+    if (input.empty()) { return input; }
+    
+    return sorter<T>(std::move(token)).do_sort(input);
+}
+}
+} // namespace ts_stack_sorter
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+namespace lf_stack_sorter {
+namespace lf {
+template <typename T>
+class stack {
+public:
+    template <typename V>
+    void push(V &&val)
+    {
+        auto new_node = std::make_shared<node>(std::forward<V>(val));
+        new_node->next_ = std::atomic_load(&head_);
+        while (!std::atomic_compare_exchange_weak(&head_, &new_node->next_, new_node));
+    }
+    
+    std::shared_ptr<T> pop()
+    {
+        auto original_head = std::atomic_load(&head_);
+        
+        // next_ has to be read atomically too - whoever wins the pop clears it with atomic_store() below
+        while (original_head && !std::atomic_compare_exchange_weak(&head_, &original_head, std::atomic_load(&original_head->next_)));
+    
+        if (original_head) {
+            std::atomic_store(&original_head->next_, {} );
+            return original_head->data_;
+        }
+        
+        return {};
+    }
+    
+    ~stack() { while(pop()); }
+    
+private:
+    struct node {
+        std::shared_ptr<T> data_;
+        std::shared_ptr<node> next_;
+        
+        template <typename D>
+        node(D &&data) : data_(std::make_shared<T>(std::forward<D>(data))), next_(nullptr) { }
+    };
+    
+    std::shared_ptr<node> head_;
+};
+} //namespace lock-free
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+namespace par {
+// thrown out of a sort that's stopped before it finishes - the list it was given is left as it was
+struct operation_cancelled : std::exception {
+    const char* what() const noexcept override { return "operation cancelled"; }
+};
+} // namespace par
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+template <typename T>
+class sorter {
+public:
+    // idle threads sleep rather than spin now, so we can start them all up front - which also means threads_ is never...
+    // ...touched from inside do_sort() (where other sorting threads would be racing to read it)
+    // token stops the sort itself - the sorting threads have stop tokens of their own, for when the sorter's done with them
+    explicit sorter(std::stop_token token = {}) : token_(std::move(token)), wake_on_stop_(token_, wake_everyone{ this })
+    {
+        // hardware_concurrency() is allowed to return 0 - which, minus one, would be a few billion threads
+        max_threads_ = std::max(1u, std::thread::hardware_concurrency()) - 1;
+        
+        try {
+            for (std::size_t i = 0; i != max_threads_; ++i) { threads_.push_back(std::jthread([this] (std::stop_token st) { sort_thread(st); } )); }
+        } catch (...) {
+            stop();
+            throw;
+        }
+    }
+    
+    ~sorter() { stop(); }
+    
+    // below this, std::list::sort on this thread beats pushing a chunk for someone else to pick up
+    static constexpr std::size_t inline_sort_size = 1024;
+    
+    std::list<T> do_sort(std::list<T> &chunk_data)
+    {
+        std::list<T> result;
+        
+        // the sides we've handed off, and where in result each one goes once it's back
+        std::vector<std::pair<std::future<std::list<T>>, typename std::list<T>::iterator>> pending;
+        
+        // ...and where whatever's left in chunk_data goes
+        auto hole = result.end();
+        
+        // anything under inline_sort_size is too small to be worth a chunk, a promise and a trip through the stack
+        while (chunk_data.size() >= inline_sort_size) {
+            // once per partition - a few hundred microseconds apart at most, even for a million elements
+            if (token_.stop_requested()) { throw par::operation_cancelled(); }
+            
+            std::list<T> equal;
+            
+            // like in chapter 4 - splice(a, b, c) -> transfer c from b before a
+            // the ninther rather than the first element, which is the worst pivot there is for sorted (or reversed) input
+            equal.splice(equal.begin(), chunk_data, ninther(chunk_data));
+            
+            const T &partition_val = *(equal.begin());
+            
+            // split em up three ways; less than pivot to the left; equal in the middle; more than pivot to the right
+            // with only two ways, every copy of the pivot goes round again - and with lots of duplicates, that's O(n) rounds
+            auto lower_end = std::partition(chunk_data.begin(), chunk_data.end(), [&] (const T &val) {
+                return val < partition_val;
+            });
+            
+            auto equal_end = std::partition(lower_end, chunk_data.end(), [&] (const T &val) {
+                return !(partition_val < val);
+            });
+            
+            std::list<T> new_lower;
+            
+            // splice(a, b, c, d) -> transfer range [c, d) from b to before a
+            new_lower.splice(new_lower.end(), chunk_data, chunk_data.begin(), lower_end);
+            equal.splice(equal.end(), chunk_data, lower_end, equal_end);
+            
+            // the middle's already sorted, and never goes round again
+            auto equal_begin = equal.begin();
+            result.splice(hole, equal);
+            
+            // chunk_data's the higher side now - only the smaller side is handed off (or sorted here), and we loop on the larger...
+            // ...rather than recursing on it, so however bad the pivots get, the stack doesn't grow
+            bool lower_is_smaller = new_lower.size() < chunk_data.size();
+            std::list<T> &smaller = lower_is_smaller ? new_lower : chunk_data;
+            auto smaller_pos = lower_is_smaller ? equal_begin : hole;
+            
+            if (smaller.size() < inline_sort_size) {
+                smaller.sort();
+                result.splice(smaller_pos, smaller);
+            } else {
+                chunk_to_sort smaller_chunk;
+                smaller_chunk.data_.splice(smaller_chunk.data_.end(), smaller);
+                
+                pending.emplace_back(smaller_chunk.promise_.get_future(), smaller_pos);
+                
+                chunks_.push(std::move(smaller_chunk));
+                
+                // one sleeper is enough - whoever wakes up takes the chunk
+                ++events_;
+                events_.notify_one();
+            }
+            
+            if (!lower_is_smaller) {
+                chunk_data.splice(chunk_data.end(), new_lower);
+                hole = equal_begin;
+            }
+        }
+        
+        chunk_data.sort();
+        result.splice(hole, chunk_data);
+        
+        // newest first - they're the smallest, and the likeliest to still be on the stack for us to sort ourselves
+        for (auto p = pending.rbegin(); p != pending.rend(); ++p) {
+            // help out with other chunks until this one's done, and sleep if there's nothing to help with...
+            // ...or until we're stopped, in which case nobody wants what's left (and the chunk's promise outlives us)
+            wait_until([&] () { return token_.stop_requested() || p->first.wait_for(std::chrono::seconds(0)) == std::future_status::ready; });
+            
+            if (token_.stop_requested()) { throw par::operation_cancelled(); }
+            
+            // splice (a, b) -> transfer all of b just before a
+            result.splice(p->second, p->first.get());
+        }
+        
+        return result;
+    }
+private:
+    struct chunk_to_sort {
+        std::list<T> data_;
+        std::promise<std::list<T>> promise_;
+    };
+    
+    lf::stack<chunk_to_sort> chunks_;
+    
+    std::vector<std::jthread> threads_;
+    
+    std::size_t max_threads_;
+    
+    // bumped whenever a chunk is pushed or finished (or we're shutting down, or stopped) - sleepers wait for it to change
+    std::atomic<unsigned> events_{0};
+    
+    struct wake_everyone {
+        sorter *s_;
+        
+        void operator()() const
+        {
+            ++s_->events_;
+            s_->events_.notify_all();
+        }
+    };
+    
+    // a stop request has to wake up anyone asleep in wait_until(), or they'd never notice it
+    // declared after events_, as the callback runs straight away if token_'s already stopped
+    std::stop_token token_;
+    std::stop_callback<wake_everyone> wake_on_stop_;
+    
+    // Tukey's ninther - the median of the medians of three groups of three, spread evenly across the chunk
+    // on a list that means walking most of it, but the partition's about to walk all of it anyway
+    static typename std::list<T>::iterator ninther(std::list<T> &data)
+    {
+        std::size_t step = data.size() / 9;
+        
+        std::array<typename std::list<T>::iterator, 9> it;
+        it[0] = data.begin();
+        for (std::size_t i = 1; i != it.size(); ++i) { it[i] = std::next(it[i - 1], step); }
+        
+        auto median_of_three = [] (auto a, auto b, auto c) {
+            if (*a < *b) { return *b < *c ? b : (*a < *c ? c : a); }
+            return *a < *c ? a : (*b < *c ? c : b);
+        };
+        
+        return median_of_three(median_of_three(it[0], it[1], it[2]),
+                               median_of_three(it[3], it[4], it[5]),
+                               median_of_three(it[6], it[7], it[8]));
+    }
+    
+    bool try_sort_chunk()
+    {
+        auto chunk = chunks_.pop();
+        if (!chunk) { return false; }
+        
+        sort_chunk(chunk);
+        return true;
+    }
+    
+    void sort_chunk(const std::shared_ptr<chunk_to_sort> &chunk)
+    {
+        try {
+            chunk->promise_.set_value(do_sort(chunk->data_));
+        } catch (...) {
+            chunk->promise_.set_exception(std::current_exception());
+        }
+        
+        // we don't know who's waiting on this one, so wake everybody
+        ++events_;
+        events_.notify_all();
+    }
+    
+    // sorts chunks until done() - and when there aren't any, blocks (no yield-spinning) until something changes
+    // events_ is read *before* the last look at the stack and done(), so a push or a finish in between can't be missed
+    template <typename Pred>
+    void wait_until(Pred done)
+    {
+        while (!done()) {
+            if (try_sort_chunk()) { continue; }
+            
+            unsigned seen = events_.load();
+            if (done() || try_sort_chunk()) { continue; }
+            
+            events_.wait(seen);
+        }
+    }
+    
+    void sort_thread(std::stop_token st)
+    {
+        wait_until([&] () { return st.stop_requested(); });
+    }
+    
+    void stop()
+    {
+        for (auto &t : threads_) { t.request_stop(); }
+        
+        // wake up anyone who's asleep waiting for work, so they see their stop request
+        wake_everyone{ this }();
+        
+        for (auto &t : threads_) { t.join(); }
+    }
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+namespace par {
+template <typename T>
+std::list<T> quick_sort(std::list<T> input, std::stop_token token = {}) {
+    // not worth starting (and stopping) the sorting threads for
+    if (input.size() < sorter<T>::inline_sort_size) {
+        input.sort();
+        return input;
+    }
+    
+    return sorter<T>(std::move(token)).do_sort(input);
+}
+}
+} // namespace lf_stack_sorter
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// ts_stack_sorter.cpp as it was - every partition gets its own chunk and promise, and the first element is the pivot
+namespace book {
+template <typename T>
+class sorter {
+public:
+    sorter()
+    {
+        max_threads_ = std::thread::hardware_concurrency() - 1;
+        still_data_.store(false);// = false;
+    }
+    
+    ~sorter()
+    {
+        still_data_.store(true);// = true;
+        for (auto &t : threads_) { t.join(); }
+    }
+    
+    std::list<T> do_sort(std::list<T> &chunk_data)
+    {
+        if (chunk_data.empty()) { return chunk_data; }
+        
+        std::list<T> result;
+        
+        // like in chapter 4 - splice(a, b, c) -> transfer c from b before a
+        result.splice(result.begin(), chunk_data, chunk_data.begin());
+        
+        const T &partition_val = *(result.begin());
+        
+        // opted for "auto"
+        // split em up; less than pivot to the left; more than pivot to the right
+        auto divide_point = std::partition(chunk_data.begin(), chunk_data.end(), [&] (const T &val) {
+            return val < partition_val;
+        });
+        
+        chunk_to_sort new_lower_chunk;
+        
+        // splice(a, b, c, d) -> transfer range (c, d] from b to before a
+        new_lower_chunk.data_.splice(new_lower_chunk.data_.end(), chunk_data, chunk_data.begin(), divide_point);
+        
+        std::future<std::list<T>> new_lower = new_lower_chunk.promise_.get_future();
+        
+        chunks_.push(std::move(new_lower_chunk));
+        
+        if (threads_.size() < max_threads_) { threads_.push_back(std::thread([this] () { sort_thread(); } )); }
+        
+        std::list<T> new_higher(do_sort(chunk_data));
+        
+        // splice (a, b) -> transfer all of b just before a
+        result.splice(result.end(), new_higher);
+        
+        while (new_lower.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            try_sort_chunk();
+        }
+        
+        // splice (a, b) -> transfer all of b just before a
+        result.splice(result.begin(), new_lower.get());
+        
+        return result;
+    }
+private:
+    struct chunk_to_sort {
+        std::list<T> data_;
+        std::promise<std::list<T>> promise_;
+    };
+    
+    ts_stack_sorter::ts::stack<chunk_to_sort> chunks_;
+    
+    std::vector<std::thread> threads_;
+    
+    std::size_t max_threads_;
+    
+    std::atomic<bool> still_data_;
+    
+    void try_sort_chunk()
+    {
+        auto chunk = chunks_.pop();
+        if (chunk) { sort_chunk(chunk); }
+    }
+    
+    void sort_chunk(const std::shared_ptr<chunk_to_sort> &chunk)
+    {
+        chunk->promise_.set_value(do_sort(chunk->data_));
+    }
+    
+    void sort_thread()
+    {
+        while (!still_data_) {
+            try_sort_chunk();
+            std::this_thread::yield();
+            
+            // yield allows the scheduler to "give way" to other threads
+            // "this should be used in a case where you are in a busy waiting state, like in a thread pool:"
+            // https://stackoverflow.com/a/11049210
+        }
+    }
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+template <typename T>
+std::list<T> quick_sort(std::list<T> input) {
+    if (input.empty()) { return input; }
+    
+    return sorter<T>().do_sort(input);
+}
+} // namespace book
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+enum class input { random, sorted, reversed, duplicates, all_equal };
+
+std::list<int> make_input(std::size_t n, input kind) {
+    std::vector<int> ivec(n);
+    std::iota(ivec.begin(), ivec.end(), 0);
+
+    switch (kind) {
+        case input::random:   std::shuffle(ivec.begin(), ivec.end(), std::mt19937(42)); break;
+        case input::sorted:   break;
+        case input::reversed: std::reverse(ivec.begin(), ivec.end()); break;
+        
+        // only 16 distinct keys - a two-way partition sends every copy of the pivot round again
+        case input::duplicates: {
+            std::mt19937 e(42);
+            for (auto &i : ivec) { i = e() % 16; }
+            break;
+        }
+        
+        case input::all_equal: std::fill(ivec.begin(), ivec.end(), 7); break;
+    }
+
+    return std::list<int>(ivec.begin(), ivec.end());
+}
+
+// range(0) is the length, range(1) is the kind of input
+template <typename Sort>
+void bm_sort(benchmark::State &state, Sort sort) {
+    auto input = make_input(state.range(0), static_cast<enum input>(state.range(1)));
+
+    for (auto _ : state) {
+        auto sorted = sort(input);
+        benchmark::DoNotOptimize(sorted);
+    }
+}
+
+static void bm_list_sort(benchmark::State &state) {
+    bm_sort(state, [] (std::list<int> ilist) { ilist.sort(); return ilist; });
+} BENCHMARK(bm_list_sort)->ArgsProduct({ { 1 << 10, 1 << 12, 1 << 16, 1 << 20 }, { 0, 1, 2, 3, 4 } })->Unit(benchmark::kMillisecond);
+
+// sorted / reversed / all-equal input is O(n^2), with n levels of recursion - it won't get much further than this
+static void bm_book_quick_sort(benchmark::State &state) {
+    bm_sort(state, [] (const std::list<int> &ilist) { return book::quick_sort(ilist); });
+} BENCHMARK(bm_book_quick_sort)->ArgsProduct({ { 1 << 10, 1 << 12 }, { 0, 1, 2, 3, 4 } })->Unit(benchmark::kMillisecond);
+
+static void bm_ts_quick_sort(benchmark::State &state) {
+    bm_sort(state, [] (const std::list<int> &ilist) { return ts_stack_sorter::par::quick_sort(ilist); });
+} BENCHMARK(bm_ts_quick_sort)->ArgsProduct({ { 1 << 10, 1 << 12, 1 << 16, 1 << 20 }, { 0, 1, 2, 3, 4 } })->Unit(benchmark::kMillisecond);
+
+static void bm_lf_quick_sort(benchmark::State &state) {
+    bm_sort(state, [] (const std::list<int> &ilist) { return lf_stack_sorter::par::quick_sort(ilist); });
+} BENCHMARK(bm_lf_quick_sort)->ArgsProduct({ { 1 << 10, 1 << 12, 1 << 16, 1 << 20 }, { 0, 1, 2, 3, 4 } })->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//  OUTPUT - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Run on (1 X 2100 MHz CPU )
+// CPU Caches:
+//   L1 Data 48 KiB (x1)
+//   L1 Instruction 32 KiB (x1)
+//   L2 Unified 2048 KiB (x1)
+//   L3 Unified 307200 KiB (x1)
+// Load Average: 0.81, 1.19, 1.40
+// ---------------------------------------------------------------------
+// Benchmark                           Time             CPU   Iterations
+// ---------------------------------------------------------------------
+// bm_list_sort/1024/0             0.098 ms        0.096 ms         6788
+// bm_list_sort/4096/0             0.571 ms        0.568 ms         1272
+// bm_list_sort/65536/0             19.3 ms         19.2 ms           41
+// bm_list_sort/1048576/0            627 ms          608 ms            1
+// bm_list_sort/1024/1             0.058 ms        0.057 ms        11379
+// bm_list_sort/4096/1             0.230 ms        0.226 ms         3261
+// bm_list_sort/65536/1             4.29 ms         4.22 ms          168
+// bm_list_sort/1048576/1           76.8 ms         76.5 ms            9
+// bm_list_sort/1024/2             0.068 ms        0.067 ms        10681
+// bm_list_sort/4096/2             0.359 ms        0.353 ms         2069
+// bm_list_sort/65536/2             6.12 ms         6.04 ms          116
+// bm_list_sort/1048576/2            109 ms          108 ms            6
+// bm_list_sort/1024/3             0.100 ms        0.099 ms         7280
+// bm_list_sort/4096/3             0.553 ms        0.548 ms         1290
+// bm_list_sort/65536/3             20.7 ms         20.6 ms           34
+// bm_list_sort/1048576/3            745 ms          740 ms            1
+// bm_list_sort/1024/4             0.070 ms        0.069 ms        10025
+// bm_list_sort/4096/4             0.230 ms        0.229 ms         2709
+// bm_list_sort/65536/4             4.36 ms         4.33 ms          176
+// bm_list_sort/1048576/4           83.2 ms         82.6 ms            7
+// bm_book_quick_sort/1024/0       0.586 ms        0.574 ms         1775
+// bm_book_quick_sort/4096/0        2.60 ms         2.54 ms          276
+// bm_book_quick_sort/1024/1        1.73 ms         1.71 ms          420
+// bm_book_quick_sort/4096/1        23.8 ms         23.5 ms           28
+// bm_book_quick_sort/1024/2        2.35 ms         2.34 ms          253
+// bm_book_quick_sort/4096/2        49.9 ms         49.3 ms           14
+// bm_book_quick_sort/1024/3       0.544 ms        0.539 ms         1774
+// bm_book_quick_sort/4096/3        3.24 ms         3.22 ms          223
+// bm_book_quick_sort/1024/4        1.62 ms         1.59 ms          444
+// bm_book_quick_sort/4096/4        24.8 ms         24.5 ms           29
+// bm_ts_quick_sort/1024/0         0.126 ms        0.124 ms         5729
+// bm_ts_quick_sort/4096/0         0.790 ms        0.774 ms          920
+// bm_ts_quick_sort/65536/0         22.2 ms         22.0 ms           35
+// bm_ts_quick_sort/1048576/0        501 ms          496 ms            2
+// bm_ts_quick_sort/1024/1         0.081 ms        0.080 ms         9128
+// bm_ts_quick_sort/4096/1         0.348 ms        0.345 ms         1972
+// bm_ts_quick_sort/65536/1         8.20 ms         8.09 ms           86
+// bm_ts_quick_sort/1048576/1        211 ms          207 ms            4
+// bm_ts_quick_sort/1024/2         0.082 ms        0.081 ms         8485
+// bm_ts_quick_sort/4096/2         0.364 ms        0.359 ms         1905
+// bm_ts_quick_sort/65536/2         8.03 ms         7.95 ms           85
+// bm_ts_quick_sort/1048576/2        204 ms          201 ms            4
+// bm_ts_quick_sort/1024/3         0.107 ms        0.105 ms         6694
+// bm_ts_quick_sort/4096/3         0.496 ms        0.491 ms         1472
+// bm_ts_quick_sort/65536/3         5.66 ms         5.59 ms          126
+// bm_ts_quick_sort/1048576/3        101 ms        100.0 ms            7
+// bm_ts_quick_sort/1024/4         0.040 ms        0.039 ms        18370
+// bm_ts_quick_sort/4096/4         0.129 ms        0.127 ms         5787
+// bm_ts_quick_sort/65536/4         2.00 ms         1.98 ms          347
+// bm_ts_quick_sort/1048576/4       53.7 ms         53.1 ms           16
+// bm_lf_quick_sort/1024/0         0.100 ms        0.098 ms         6233
+// bm_lf_quick_sort/4096/0         0.648 ms        0.641 ms         1260
+// bm_lf_quick_sort/65536/0         20.2 ms         20.0 ms           42
+// bm_lf_quick_sort/1048576/0        461 ms          456 ms            2
+// bm_lf_quick_sort/1024/1         0.070 ms        0.068 ms         8940
+// bm_lf_quick_sort/4096/1         0.281 ms        0.277 ms         2614
+// bm_lf_quick_sort/65536/1         7.09 ms         7.01 ms          112
+// bm_lf_quick_sort/1048576/1        190 ms          187 ms            4
+// bm_lf_quick_sort/1024/2         0.071 ms        0.071 ms         9396
+// bm_lf_quick_sort/4096/2         0.289 ms        0.287 ms         2138
+// bm_lf_quick_sort/65536/2         7.35 ms         7.26 ms          110
+// bm_lf_quick_sort/1048576/2        182 ms          180 ms            4
+// bm_lf_quick_sort/1024/3         0.099 ms        0.098 ms         7076
+// bm_lf_quick_sort/4096/3         0.373 ms        0.369 ms         1649
+// bm_lf_quick_sort/65536/3         4.81 ms         4.73 ms          157
+// bm_lf_quick_sort/1048576/3       92.3 ms         91.1 ms            8
+// bm_lf_quick_sort/1024/4         0.030 ms        0.030 ms        22660
+// bm_lf_quick_sort/4096/4         0.148 ms        0.145 ms         5868
+// bm_lf_quick_sort/65536/4         2.07 ms         2.04 ms          277
+// bm_lf_quick_sort/1048576/4       53.7 ms         53.6 ms           10
+// Program ended with exit code: 0
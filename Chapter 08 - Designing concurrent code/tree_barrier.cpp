@@ -0,0 +1,336 @@
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#ifdef __cpp_lib_hardware_interference_size
+constexpr std::size_t cache_line_size = std::hardware_destructive_interference_size;
+#else
+constexpr std::size_t cache_line_size = 64;
+#endif
+
+// the book's barrier (barrier.cpp) - everyone hammers spaces_, then yield-spins on generation_
+class barrier {
+public:
+    barrier(std::size_t count) : count_(count), spaces_(count), generation_(0) { }
+
+    void wait(std::size_t = 0)
+    {
+        std::size_t my_gen = generation_.load();
+
+        if (!--spaces_) {
+            spaces_ = count_.load();
+            ++generation_;
+        } else {
+            while (generation_.load() == my_gen) { std::this_thread::yield(); }
+        }
+    }
+
+    void done_waiting(std::size_t = 0)
+    {
+        --count_;
+
+        if (!--spaces_) {
+            spaces_ = count_.load();
+            ++generation_;
+        }
+    }
+
+private:
+    std::atomic<std::size_t> count_;
+
+    std::atomic<std::size_t> spaces_;
+    std::atomic<std::size_t> generation_;
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+enum class wait_policy { spin, block };
+
+// combining tree - threads arrive at a leaf shared with (at most) 3 others, the last one in carries on up to the parent,...
+// ...and whoever completes the root flips the global sense to let everyone go
+// each counter only sees fan_in threads, so there's no single hot cache line on the way in
+class tree_barrier {
+public:
+    static constexpr std::size_t fan_in = 4;
+
+    explicit tree_barrier(std::size_t count, wait_policy policy = wait_policy::spin)
+        : policy_(policy), senses_(std::make_unique<local_sense[]>(count))
+    {
+        // build the tree bottom-up - level 0 holds the leaves
+        std::size_t level_start = 0, level_size = (count + fan_in - 1) / fan_in;
+        nodes_ = std::make_unique<node[]>(node_count(count));
+
+        for (std::size_t i = 0; i != level_size; ++i) {
+            std::size_t arrivals = std::min(fan_in, count - i * fan_in);
+            nodes_[i].expected_ = arrivals;
+            nodes_[i].remaining_ = arrivals;
+        }
+
+        while (level_size > 1) {
+            std::size_t parent_start = level_start + level_size;
+            std::size_t parent_size = (level_size + fan_in - 1) / fan_in;
+
+            for (std::size_t i = 0; i != level_size; ++i) { nodes_[level_start + i].parent_ = &nodes_[parent_start + i / fan_in]; }
+
+            for (std::size_t i = 0; i != parent_size; ++i) {
+                std::size_t arrivals = std::min(fan_in, level_size - i * fan_in);
+                nodes_[parent_start + i].expected_ = arrivals;
+                nodes_[parent_start + i].remaining_ = arrivals;
+            }
+
+            level_start = parent_start;
+            level_size = parent_size;
+        }
+    }
+
+    tree_barrier(const tree_barrier&) = delete;
+    tree_barrier& operator=(const tree_barrier&) = delete;
+
+    // id is the thread's index in [0, count) - it decides which leaf the thread arrives at
+    void wait(std::size_t id)
+    {
+        bool my_sense = !senses_[id].sense_;
+        senses_[id].sense_ = my_sense;
+
+        if (arrive(&nodes_[id / fan_in], my_sense)) { return; }
+
+        if (policy_ == wait_policy::block) {
+            sense_.wait(!my_sense, std::memory_order_acquire);
+            return;
+        }
+
+        for (unsigned spins = 0; sense_.load(std::memory_order_acquire) != my_sense; ++spins) {
+            if (spins >= 64) { std::this_thread::yield(); }
+        }
+    }
+
+    // same as the book - arrive for this phase, but don't wait and don't count us in any future phase
+    void done_waiting(std::size_t id)
+    {
+        bool my_sense = !senses_[id].sense_;
+        senses_[id].sense_ = my_sense;
+
+        // if we were the last thread on this leaf, the leaf stops arriving at its parent too, and so on up the tree
+        // this has to happen *before* we arrive, so whoever resets the counters below sees the new totals
+        for (node *n = &nodes_[id / fan_in]; n && n->expected_.fetch_sub(1, std::memory_order_relaxed) == 1; n = n->parent_);
+
+        arrive(&nodes_[id / fan_in], my_sense);
+    }
+
+private:
+    struct alignas(cache_line_size) node {
+        std::atomic<std::size_t> remaining_{0};
+        std::atomic<std::size_t> expected_{0};
+        node *parent_ = nullptr;
+    };
+
+    struct alignas(cache_line_size) local_sense {
+        bool sense_ = false;
+    };
+
+    const wait_policy policy_;
+
+    std::unique_ptr<node[]> nodes_;
+    std::unique_ptr<local_sense[]> senses_;
+
+    alignas(cache_line_size) std::atomic<bool> sense_{false};
+
+    static std::size_t node_count(std::size_t count)
+    {
+        std::size_t total = 0;
+        for (std::size_t level = (count + fan_in - 1) / fan_in; ; level = (level + fan_in - 1) / fan_in) {
+            total += level;
+            if (level <= 1) { return total; }
+        }
+    }
+
+    // returns true if we were the one to complete the phase (and so don't need to wait)
+    bool arrive(node *n, bool my_sense)
+    {
+        while (n->remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            // last one here - reset for the next phase *before* anybody can be released into it
+            n->remaining_.store(n->expected_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+            if (!n->parent_) {
+                sense_.store(my_sense, std::memory_order_release);
+                if (policy_ == wait_policy::block) { sense_.notify_all(); }
+                return true;
+            }
+
+            n = n->parent_;
+        }
+
+        return false;
+    }
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+class join_threads {
+public:
+    explicit join_threads(std::vector<std::thread> &threads) : threads_(threads) { }
+
+    ~join_threads()
+    {
+        for (auto &t : threads_)
+            if (t.joinable()) { t.join(); }
+    }
+private:
+    std::vector<std::thread> &threads_;
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// parrer_partial_sum.cpp, but on the tree barrier - threads drop out with done_waiting() as their stride runs out
+namespace par {
+template <typename _Iterator>
+void partial_sum(_Iterator __first, _Iterator __last) {
+    typedef typename _Iterator::value_type T;
+
+    struct process_element {
+        void operator() (_Iterator __first, std::vector<T> &buffer, std::size_t i, tree_barrier &b)
+        {
+            T &ith_element = *(__first + i);
+            bool update_source = false;
+
+            for (std::size_t step = 0, stride = 1; stride <= i; ++step, stride *= 2) {
+                T &source = step % 2 ? buffer[i]          : ith_element;
+                T &dest   = step % 2 ? ith_element        : buffer[i];
+                T &addend = step % 2 ? buffer[i - stride] : *(__first + i - stride);
+
+                dest = source + addend;
+                update_source = !(step % 2);
+                b.wait(i);
+            }
+
+            if (update_source) {
+                ith_element = buffer[i];
+            } else {
+                buffer[i] = ith_element;
+            }
+
+            b.done_waiting(i);
+        }
+    };
+
+    std::size_t length = std::distance(__first, __last);
+    if (!length) { return; }
+
+    std::vector<T> buffer(length);
+    tree_barrier b(length);
+
+    std::vector<std::thread> threads(length - 1);
+    join_threads joiner(threads);
+
+    for (std::size_t i = 0; i != length - 1; ++i) {
+        threads[i] = std::thread(process_element(), __first, std::ref(buffer), i, std::ref(b));
+    }
+
+    process_element()(__first, buffer, length - 1, b);
+}
+} // namespace par (parallel)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// std::barrier has no thread index, so give it the same signature as the others
+class std_barrier {
+public:
+    explicit std_barrier(std::size_t count) : b_(count) { }
+    void wait(std::size_t) { b_.arrive_and_wait(); }
+private:
+    std::barrier<> b_;
+};
+
+template <typename Barrier>
+double ns_per_phase(std::size_t num_threads, std::size_t phases, Barrier &b) {
+    std::vector<std::thread> threads(num_threads - 1);
+    std::chrono::steady_clock::time_point start, stop;
+
+    {
+        join_threads joiner(threads);
+
+        for (std::size_t i = 0; i != num_threads - 1; ++i) {
+            threads[i] = std::thread([&b, i, phases] () {
+                for (std::size_t p = 0; p != phases + 1; ++p) { b.wait(i); }
+            });
+        }
+
+        b.wait(num_threads - 1); // line everyone up before starting the clock
+        start = std::chrono::steady_clock::now();
+        for (std::size_t p = 0; p != phases; ++p) { b.wait(num_threads - 1); }
+        stop = std::chrono::steady_clock::now();
+    }
+
+    return std::chrono::duration<double, std::nano>(stop - start).count() / phases;
+}
+
+void printVec(const std::vector<int> &ivec) {
+    for (int i : ivec) {
+        std::cout << i << ' ';
+    } std::cout << '\n';
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int main()
+{
+    std::vector<int> ivec  = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    std::vector<int> ivec2(ivec.begin(), ivec.end());
+
+    std::cout << "ivec: "; printVec(ivec);
+
+    par::partial_sum(ivec.begin(), ivec.end());
+    std::cout << "par:  "; printVec(ivec);
+
+    std::partial_sum(ivec2.begin(), ivec2.end(), ivec2.begin());
+    std::cout << "std:  "; printVec(ivec2);
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+    const std::size_t phases = 200;
+
+    std::cout << "\nns per phase (" << std::thread::hardware_concurrency() << " hardware threads)\n";
+    std::cout << std::setw(8) << "threads" << std::setw(14) << "barrier" << std::setw(14) << "tree (spin)"
+              << std::setw(14) << "tree (block)" << std::setw(14) << "std::barrier" << '\n';
+
+    for (std::size_t n = 2; n <= 128; n *= 2) {
+        barrier b1(n);
+        tree_barrier b2(n, wait_policy::spin);
+        tree_barrier b3(n, wait_policy::block);
+        std_barrier b4(n);
+
+        std::cout << std::setw(8) << n << std::fixed << std::setprecision(0)
+                  << std::setw(14) << ns_per_phase(n, phases, b1)
+                  << std::setw(14) << ns_per_phase(n, phases, b2)
+                  << std::setw(14) << ns_per_phase(n, phases, b3)
+                  << std::setw(14) << ns_per_phase(n, phases, b4) << '\n';
+    }
+
+    return 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//  OUTPUT - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// ivec: 1 2 3 4 5 6 7 8 9 
+// par:  1 3 6 10 15 21 28 36 45 
+// std:  1 3 6 10 15 21 28 36 45 
+//
+// ns per phase (1 hardware threads)
+//  threads       barrier   tree (spin)  tree (block)  std::barrier
+//        2           592           615          1041          1165
+//        4          1753          1881          2649          2690
+//        8          4405          4468          6021          6209
+//       16          9571         10160         12992         13484
+//       32         23996         22033         26713         28248
+//       64         40888         43761         55534         55913
+//      128         86053        108724        114894        119211
+// Program ended with exit code: 0
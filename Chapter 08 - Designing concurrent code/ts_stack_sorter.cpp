@@ -1,11 +1,19 @@
+#include <algorithm>
+#include <array>
 #include <stack>
 // #include <mutex>
 // #include <memory>
 #include <iostream>
+#include <numeric>
+#include <random>
+#include <stop_token>
+#include <string>
+#include <utility>
+#include <iterator>
 #include <list>
 #include <future>
-// #include <vector>
-// #include <thread>
+#include <vector>
+#include <thread>
 // #include <atomic>
 
 namespace ts {
@@ -54,64 +62,120 @@ private:
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+namespace par {
+// thrown out of a sort that's stopped before it finishes - the list it was given is left as it was
+struct operation_cancelled : std::exception {
+    const char* what() const noexcept override { return "operation cancelled"; }
+};
+} // namespace par
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
 template <typename T>
 class sorter {
 public:
-    sorter()
+    // token stops the sort itself - the sorting threads have stop tokens of their own, for when the sorter's done with them
+    explicit sorter(std::stop_token token = {}) : token_(std::move(token))
     {
         max_threads_ = std::thread::hardware_concurrency() - 1;
-        still_data_.store(false);// = false;
     }
     
     ~sorter()
     {
-        still_data_.store(true);// = true;
+        for (auto &t : threads_) { t.request_stop(); }
         for (auto &t : threads_) { t.join(); }
     }
     
     std::list<T> do_sort(std::list<T> &chunk_data)
     {
-        if (chunk_data.empty()) { return chunk_data; }
-        
         std::list<T> result;
         
-        // like in chapter 4 - splice(a, b, c) -> transfer c from b before a
-        result.splice(result.begin(), chunk_data, chunk_data.begin());
-        
-        const T &partition_val = *(result.begin());
+        // the sides we've handed off, and where in result each one goes once it's back
+        std::vector<std::pair<std::future<std::list<T>>, typename std::list<T>::iterator>> pending;
         
-        // opted for "auto"
-        // split em up; less than pivot to the left; more than pivot to the right
-        auto divide_point = std::partition(chunk_data.begin(), chunk_data.end(), [&] (const T &val) {
-            return val < partition_val;
-        });
+        // ...and where whatever's left in chunk_data goes
+        auto hole = result.end();
         
-        chunk_to_sort new_lower_chunk;
-        
-        // splice(a, b, c, d) -> transfer range (c, d] from b to before a
-        new_lower_chunk.data_.splice(new_lower_chunk.data_.end(), chunk_data, chunk_data.begin(), divide_point);
-        
-        std::future<std::list<T>> new_lower = new_lower_chunk.promise_.get_future();
-        
-        chunks_.push(std::move(new_lower_chunk));
-        
-        if (threads_.size() < max_threads_) { threads_.push_back(std::thread([this] () { sort_thread(); } )); }
-        
-        std::list<T> new_higher(do_sort(chunk_data));
+        // anything under inline_sort_size is too small to be worth a chunk, a promise and a trip through the stack
+        while (chunk_data.size() >= inline_sort_size) {
+            // once per partition - a few hundred microseconds apart at most, even for a million elements
+            if (token_.stop_requested()) { throw par::operation_cancelled(); }
+            
+            std::list<T> equal;
+            
+            // like in chapter 4 - splice(a, b, c) -> transfer c from b before a
+            // the ninther rather than the first element, which is the worst pivot there is for sorted (or reversed) input
+            equal.splice(equal.begin(), chunk_data, ninther(chunk_data));
+            
+            const T &partition_val = *(equal.begin());
+            
+            // split em up three ways; less than pivot to the left; equal in the middle; more than pivot to the right
+            // with only two ways, every copy of the pivot goes round again - and with lots of duplicates, that's O(n) rounds
+            auto lower_end = std::partition(chunk_data.begin(), chunk_data.end(), [&] (const T &val) {
+                return val < partition_val;
+            });
+            
+            auto equal_end = std::partition(lower_end, chunk_data.end(), [&] (const T &val) {
+                return !(partition_val < val);
+            });
+            
+            std::list<T> new_lower;
+            
+            // splice(a, b, c, d) -> transfer range [c, d) from b to before a
+            new_lower.splice(new_lower.end(), chunk_data, chunk_data.begin(), lower_end);
+            equal.splice(equal.end(), chunk_data, lower_end, equal_end);
+            
+            // the middle's already sorted, and never goes round again
+            auto equal_begin = equal.begin();
+            result.splice(hole, equal);
+            
+            // chunk_data's the higher side now - only the smaller side is handed off (or sorted here), and we loop on the larger...
+            // ...rather than recursing on it, so however bad the pivots get, the stack doesn't grow
+            bool lower_is_smaller = new_lower.size() < chunk_data.size();
+            std::list<T> &smaller = lower_is_smaller ? new_lower : chunk_data;
+            auto smaller_pos = lower_is_smaller ? equal_begin : hole;
+            
+            if (smaller.size() < inline_sort_size) {
+                smaller.sort();
+                result.splice(smaller_pos, smaller);
+            } else {
+                chunk_to_sort smaller_chunk;
+                smaller_chunk.data_.splice(smaller_chunk.data_.end(), smaller);
+                
+                pending.emplace_back(smaller_chunk.promise_.get_future(), smaller_pos);
+                
+                chunks_.push(std::move(smaller_chunk));
+                
+                if (threads_.size() < max_threads_) { threads_.push_back(std::jthread([this] (std::stop_token st) { sort_thread(st); } )); }
+            }
+            
+            if (!lower_is_smaller) {
+                chunk_data.splice(chunk_data.end(), new_lower);
+                hole = equal_begin;
+            }
+        }
         
-        // splice (a, b) -> transfer all of b just before a
-        result.splice(result.end(), new_higher);
+        chunk_data.sort();
+        result.splice(hole, chunk_data);
         
-        while (new_lower.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
-            try_sort_chunk();
+        // newest first - they're the smallest, and the likeliest to still be on the stack for us to sort ourselves
+        for (auto p = pending.rbegin(); p != pending.rend(); ++p) {
+            // once we're stopped, nobody wants what's left (and the chunk's promise outlives us)
+            while (p->first.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                if (token_.stop_requested()) { throw par::operation_cancelled(); }
+                try_sort_chunk();
+            }
+            
+            // splice (a, b) -> transfer all of b just before a
+            result.splice(p->second, p->first.get());
         }
         
-        // splice (a, b) -> transfer all of b just before a
-        result.splice(result.begin(), new_lower.get());
-        
         return result;
     }
 private:
+    // below this, std::list::sort on this thread beats pushing a chunk for someone else to pick up
+    static constexpr std::size_t inline_sort_size = 1024;
+    
     struct chunk_to_sort {
         std::list<T> data_;
         std::promise<std::list<T>> promise_;
@@ -119,11 +183,31 @@ private:
     
     ts::stack<chunk_to_sort> chunks_;
     
-    std::vector<std::thread> threads_;
+    std::stop_token token_;
+    
+    std::vector<std::jthread> threads_;
     
     std::size_t max_threads_;
     
-    std::atomic<bool> still_data_;
+    // Tukey's ninther - the median of the medians of three groups of three, spread evenly across the chunk
+    // on a list that means walking most of it, but the partition's about to walk all of it anyway
+    static typename std::list<T>::iterator ninther(std::list<T> &data)
+    {
+        std::size_t step = data.size() / 9;
+        
+        std::array<typename std::list<T>::iterator, 9> it;
+        it[0] = data.begin();
+        for (std::size_t i = 1; i != it.size(); ++i) { it[i] = std::next(it[i - 1], step); }
+        
+        auto median_of_three = [] (auto a, auto b, auto c) {
+            if (*a < *b) { return *b < *c ? b : (*a < *c ? c : a); }
+            return *a < *c ? a : (*b < *c ? c : b);
+        };
+        
+        return median_of_three(median_of_three(it[0], it[1], it[2]),
+                               median_of_three(it[3], it[4], it[5]),
+                               median_of_three(it[6], it[7], it[8]));
+    }
     
     void try_sort_chunk()
     {
@@ -133,12 +217,16 @@ private:
     
     void sort_chunk(const std::shared_ptr<chunk_to_sort> &chunk)
     {
-        chunk->promise_.set_value(do_sort(chunk->data_));
+        try {
+            chunk->promise_.set_value(do_sort(chunk->data_));
+        } catch (...) {
+            chunk->promise_.set_exception(std::current_exception());
+        }
     }
     
-    void sort_thread()
+    void sort_thread(std::stop_token st)
     {
-        while (!still_data_) {
+        while (!st.stop_requested()) {
             try_sort_chunk();
             std::this_thread::yield();
             
@@ -153,10 +241,10 @@ private:
 
 namespace par {
 template <typename T>
-std::list<T> quick_sort(std::list<T> input) {
+std::list<T> quick_sort(std::list<T> input, std::stop_token token = {}) {
     if (input.empty()) { return input; }
     
-    return sorter<T>().do_sort(input);
+    return sorter<T>(std::move(token)).do_sort(input);
 }
 }
 
@@ -171,6 +259,25 @@ void print_list(const std::list<T> &tl) {
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
+// sorts on another thread, and stops it 10ms in
+template <typename T>
+std::string cancel_sort(const std::list<T> &tl) {
+    std::stop_source stop;
+    auto sorting = std::async(std::launch::async, [&] () { return par::quick_sort(tl, stop.get_token()); });
+    
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    stop.request_stop();
+    
+    try {
+        sorting.get();
+        return "finished anyway";
+    } catch (const par::operation_cancelled &e) {
+        return e.what();
+    }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
 int main()
 {
     std::list<int> il = { 1, 5 ,4, 2, 3, 6, 7, 2, 1, 5 ,4, 3, 6, 7 };
@@ -181,6 +288,28 @@ int main()
     std::cout << "after:  ";
     print_list(sorted);
     
+    // with the first element as the pivot, sorted / reversed input meant a million levels of recursion (and a crash)
+    std::list<int> ascending(1'000'000), descending;
+    std::iota(ascending.begin(), ascending.end(), 0);
+    descending.assign(ascending.rbegin(), ascending.rend());
+    
+    std::cout << "\nsorted:     " << (par::quick_sort(ascending) == ascending ? "ok" : "NOT ok") << '\n';
+    std::cout << "reversed:   " << (par::quick_sort(descending) == ascending ? "ok" : "NOT ok") << '\n';
+    
+    // ...and with a two-way partition, lots of duplicates meant the same (every copy of the pivot went round again)
+    std::mt19937 e(42);
+    std::list<int> duplicates(1'000'000), all_equal(1'000'000, 7);
+    for (auto &i : duplicates) { i = e() % 16; }
+    
+    auto expected = duplicates;
+    expected.sort();
+    
+    std::cout << "duplicates: " << (par::quick_sort(duplicates) == expected ? "ok" : "NOT ok") << '\n';
+    std::cout << "all equal:  " << (par::quick_sort(all_equal) == all_equal ? "ok" : "NOT ok") << '\n';
+    
+    // ...and a sort nobody wants any more - stopped part-way through, it throws rather than handing back half a job
+    std::cout << "stopped:    " << cancel_sort(duplicates) << '\n';
+    
     return 0;
 }
 
@@ -188,6 +317,12 @@ int main()
 //  OUTPUT - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-// before: 1 5 4 2 3 6 7 2 1 5 4 3 6 7
-// after:  1 1 2 2 3 3 4 4 5 5 6 6 7 7
+// before: 1 5 4 2 3 6 7 2 1 5 4 3 6 7 
+// after:  1 1 2 2 3 3 4 4 5 5 6 6 7 7 
+//
+// sorted:     ok
+// reversed:   ok
+// duplicates: ok
+// all equal:  ok
+// stopped:    operation cancelled
 // Program ended with exit code: 0
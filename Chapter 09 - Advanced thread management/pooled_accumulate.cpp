@@ -0,0 +1,433 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <vector>
+#include <thread>
+#include <numeric>
+#include <iostream>
+#include <future>
+#include <condition_variable>
+
+namespace mt {
+template <typename T>
+class queue {
+public:
+    queue() : head_(std::make_unique<node>()), tail_(head_.get()) { }
+    
+    queue(const queue&) = delete;
+    queue& operator=(const queue&) = delete;
+    
+    std::shared_ptr<T> try_pop()
+    {
+        std::unique_ptr<node> old_head = try_pop_head();
+        return old_head ? old_head->data_ : std::shared_ptr<T>();
+    }
+    
+    bool try_pop(T &val)
+    {
+        std::unique_ptr<node> old_head = try_pop_head(val);
+        return old_head.get();
+    }
+    
+    std::shared_ptr<T> wait_and_pop()
+    {
+        std::unique_ptr<node> old_head = wait_pop_head();
+        return old_head->data_;
+    }
+    
+    void wait_and_pop(T &val)
+    {
+        std::unique_ptr<node> old_head = wait_pop_head(val);
+    }
+    
+    template <typename V>
+    void push(V &&val)
+    {
+        auto new_data = std::make_shared<T>(std::forward<V>(val));
+        auto p = std::make_unique<node>();
+        
+        {
+            std::lock_guard lock(tail_m);
+            tail_->data_ = new_data;
+            node *new_tail = p.get();
+            tail_->next_ = std::move(p);
+            tail_ = new_tail;
+        }
+        
+        cv.notify_one();
+    }
+    
+    bool empty() const
+    {
+        std::lock_guard lock(head_m);
+        return head_.get() == get_tail();
+    }
+    
+private:
+    struct node
+    {
+        std::shared_ptr<T> data_;
+        std::unique_ptr<node> next_;
+    };
+    
+    std::unique_ptr<node> pop_head()
+    {
+        std::unique_ptr<node> old_head = std::move(head_);
+        head_ = std::move(old_head->next_);
+        return old_head;
+    }
+    
+    std::unique_lock<std::mutex> wait_for_data()
+    {
+        std::unique_lock<std::mutex> lock(head_m);
+        cv.wait(lock, [&] () { return head_.get() != get_tail(); } );
+        return lock;
+    }
+    
+    std::unique_ptr<node> wait_pop_head()
+    {
+        std::unique_lock<std::mutex> lock(wait_for_data());
+        return pop_head();
+    }
+    
+    std::unique_ptr<node> wait_pop_head(T &val)
+    {
+        std::unique_lock<std::mutex> lock(wait_for_data());
+        val = std::move(*head_->data_);
+        return pop_head();;
+    }
+    
+    node* get_tail() const
+    {
+        std::lock_guard lock(tail_m);
+        return tail_;
+    }
+    
+    std::unique_ptr<node> try_pop_head()
+    {
+        std::lock_guard lock(head_m);
+        if (head_.get() == get_tail()) { return std::unique_ptr<node>(); }
+        return pop_head();
+    }
+    
+    std::unique_ptr<node> try_pop_head(T &val)
+    {
+        std::lock_guard lock(head_m);
+        if (head_.get() == get_tail()) { return std::unique_ptr<node>(); }
+        val = std::move(*head_->data_);
+        return pop_head();
+    }
+    
+    std::unique_ptr<node> head_;
+    node *tail_;
+    
+    mutable std::mutex head_m;
+    mutable std::mutex tail_m;
+    
+    std::condition_variable cv;
+};
+} // namespace mt (multi-threaded)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+class join_threads {
+public:
+    explicit join_threads(std::vector<std::thread> &threads) : threads_(threads) { }
+    
+    ~join_threads()
+    {
+        for (auto &t : threads_)
+            if (t.joinable()) { t.join(); }
+    }
+    
+private:
+    std::vector<std::thread> &threads_;
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+class function_wrapper {
+public:
+    function_wrapper() = default;
+    
+    function_wrapper(const function_wrapper&) = delete;
+    function_wrapper(function_wrapper&) = delete;
+    function_wrapper& operator=(const function_wrapper&) = delete;
+    
+    function_wrapper(function_wrapper &&other) noexcept : impl_(std::move(other.impl_)) { }
+    
+    function_wrapper& operator=(function_wrapper &&rhs) noexcept
+    {
+        impl_ = std::move(rhs.impl_);
+        return *this;
+    }
+    
+    template <typename Func>
+    // function_wrapper(Func &&f) : impl_(new impl_type<Func>(std::move(f))) { }
+    function_wrapper(Func &&f) noexcept : impl_(std::make_unique<impl_type<Func>>(std::move(f))) { }
+    
+    void operator() () { impl_->call(); }
+    
+    
+private:
+    struct impl_base {
+        // abstract base class
+        virtual void call() = 0;
+        virtual ~impl_base() { }
+    };
+    
+    std::unique_ptr<impl_base> impl_;
+    
+    template <typename Func>
+    struct impl_type : impl_base {
+        Func f_;
+        
+        impl_type(Func &&f) : f_(std::move(f)) { }
+        void call() { f_(); }
+    };
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// long-lived pool - same as waitable_thread_pool.cpp, except idle workers now block in wait_and_pop()...
+// ...instead of yield-spinning, so keeping one around between calls doesn't cost a core
+class thread_pool {
+public:
+    explicit thread_pool(std::size_t thread_count = default_thread_count()) : done_(false), joiner_(threads_)
+    {
+        try {
+            for (std::size_t i = 0; i != thread_count; ++i)
+                threads_.push_back(std::thread(&thread_pool::worker_thread, this));
+        } catch (...) {
+            shutdown();
+            throw;
+        }
+    }
+    
+    ~thread_pool() { shutdown(); }
+    
+    template <typename Func>
+    std::future<std::invoke_result_t<Func&&>> submit(Func f)
+    {
+        typedef std::invoke_result_t<Func&&> T;
+        
+        std::packaged_task<T()> task(std::move(f));
+        std::future<T> result(task.get_future());
+        workq_.push(std::move(task));
+        
+        return result;
+    }
+    
+    // lets a thread that's waiting on the pool lend a hand - returns false if there was nothing to do
+    bool run_pending_task()
+    {
+        function_wrapper task;
+        if (!workq_.try_pop(task)) { return false; }
+        task();
+        return true;
+    }
+    
+    std::size_t thread_count() const { return threads_.size(); }
+    
+private:
+    std::atomic<bool> done_;
+    
+    mt::queue<function_wrapper> workq_;
+    
+    std::vector<std::thread> threads_;
+    join_threads joiner_;
+    
+    static std::size_t default_thread_count()
+    {
+        std::size_t hw_threads = std::thread::hardware_concurrency();
+        return hw_threads > 1 ? hw_threads - 1 : 1; // the caller makes up the numbers
+    }
+    
+    void worker_thread()
+    {
+        while (!done_) {
+            function_wrapper task;
+            workq_.wait_and_pop(task);
+            task();
+        }
+    }
+    
+    // one no-op per worker to wake it up so it can see done_
+    void shutdown()
+    {
+        done_ = true;
+        for (std::size_t i = 0; i != threads_.size(); ++i) { workq_.push([] () { }); }
+    }
+};
+
+// created on first use, joined at exit
+inline thread_pool& shared_pool() {
+    static thread_pool pool;
+    return pool;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+template <typename __ForwardIt, typename __Tp>
+struct accumulate_block {
+    __Tp operator() (__ForwardIt first, __ForwardIt last)
+    {
+        return std::accumulate(first, last, __Tp{});
+    }
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// listing 9.3 as it was - a brand-new pool per call and 25-element blocks
+namespace book {
+template <typename _ForwardIt, typename _Tp>
+_Tp accumulate(_ForwardIt __first, _ForwardIt __last, _Tp __init) {
+    std::size_t length = std::distance(__first, __last);
+    if (!length) { return __init; }
+    
+    std::size_t block_size = 25;
+    std::size_t num_blocks = (length + block_size - 1) / block_size;
+    
+    std::vector<std::future<_Tp>> futures(num_blocks - 1);
+    thread_pool pool(std::thread::hardware_concurrency() + 1);
+    
+    _ForwardIt block_start = __first;
+    
+    for (std::size_t i = 0; i != num_blocks - 1; ++i) {
+        _ForwardIt block_end = block_start;
+        std::advance(block_end, block_size);
+        
+        futures[i] = pool.submit([=] () {
+            return accumulate_block<_ForwardIt, _Tp>()(block_start, block_end);
+        });
+        
+        block_start = block_end;
+    }
+    
+    _Tp final_result = accumulate_block<_ForwardIt, _Tp>()(block_start, __last);
+    
+    _Tp result = __init;
+    for (auto &f : futures) { result += f.get(); }
+    result += final_result;
+    
+    return result;
+}
+} // namespace book
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+namespace par {
+// below this many elements per block, the cost of a task (allocation, queue push / pop, future) outweighs the work
+constexpr std::size_t min_block_size = 8192;
+
+// a few blocks per worker so one slow block doesn't leave everyone else idle
+constexpr std::size_t blocks_per_worker = 4;
+
+template <typename _ForwardIt, typename _Tp>
+_Tp accumulate(_ForwardIt __first, _ForwardIt __last, _Tp __init) {
+    std::size_t length = std::distance(__first, __last);
+    
+    thread_pool &pool = shared_pool();
+    std::size_t workers = pool.thread_count() + 1; // +1 for this thread
+    std::size_t num_blocks = std::min(workers * blocks_per_worker, length / min_block_size);
+    
+    // too small to be worth splitting up
+    if (num_blocks < 2) { return std::accumulate(__first, __last, __init); }
+    
+    std::size_t block_size = length / num_blocks;
+    
+    std::vector<std::future<_Tp>> futures(num_blocks - 1);
+    
+    _ForwardIt block_start = __first;
+    
+    for (auto &f : futures) {
+        _ForwardIt block_end = block_start;
+        std::advance(block_end, block_size);
+        
+        f = pool.submit([=] () {
+            return accumulate_block<_ForwardIt, _Tp>()(block_start, block_end);
+        });
+        
+        block_start = block_end;
+    }
+    
+    _Tp result = __init;
+    result += accumulate_block<_ForwardIt, _Tp>()(block_start, __last);
+    
+    // help out while there's still work queued up, then block - no spinning, and no deadlock if we're a pool task ourselves
+    for (auto &f : futures) {
+        while (f.wait_for(std::chrono::seconds(0)) != std::future_status::ready && pool.run_pending_task());
+        result += f.get();
+    }
+    
+    return result;
+}
+} // namespace par
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+std::vector<int> make_input(std::size_t n) {
+    std::vector<int> ivec(n);
+    std::iota(ivec.begin(), ivec.end(), 0);
+    return ivec;
+}
+
+static void bm_std_acc(benchmark::State &state) {
+    auto ivec = make_input(state.range(0));
+    for (auto _ : state) {
+        auto res = std::accumulate(ivec.begin(), ivec.end(), 0LL);
+        benchmark::DoNotOptimize(res);
+    }
+} BENCHMARK(bm_std_acc)->RangeMultiplier(32)->Range(1 << 10, 1 << 20);
+
+static void bm_book_acc(benchmark::State &state) {
+    auto ivec = make_input(state.range(0));
+    for (auto _ : state) {
+        auto res = book::accumulate(ivec.begin(), ivec.end(), 0LL);
+        benchmark::DoNotOptimize(res);
+    }
+} BENCHMARK(bm_book_acc)->RangeMultiplier(32)->Range(1 << 10, 1 << 20);
+
+static void bm_par_acc(benchmark::State &state) {
+    auto ivec = make_input(state.range(0));
+    
+    // make sure the answer's right before timing it
+    if (par::accumulate(ivec.begin(), ivec.end(), 0LL) != std::accumulate(ivec.begin(), ivec.end(), 0LL)) {
+        state.SkipWithError("par::accumulate gave the wrong answer");
+        return;
+    }
+    
+    for (auto _ : state) {
+        auto res = par::accumulate(ivec.begin(), ivec.end(), 0LL);
+        benchmark::DoNotOptimize(res);
+    }
+} BENCHMARK(bm_par_acc)->RangeMultiplier(32)->Range(1 << 10, 1 << 20);
+
+BENCHMARK_MAIN();
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//  OUTPUT - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// Run on (1 X 2100 MHz CPU )
+// CPU Caches:
+//   L1 Data 48 KiB (x1)
+//   L1 Instruction 32 KiB (x1)
+//   L2 Unified 2048 KiB (x1)
+//   L3 Unified 307200 KiB (x1)
+// Load Average: 2.23, 1.37, 0.56
+// --------------------------------------------------------------
+// Benchmark                    Time             CPU   Iterations
+// --------------------------------------------------------------
+// bm_std_acc/1024            349 ns          348 ns       403044
+// bm_std_acc/32768         11991 ns        11978 ns        12943
+// bm_std_acc/1048576      363835 ns       355979 ns          286
+// bm_book_acc/1024         44358 ns        20737 ns         6896
+// bm_book_acc/32768       678424 ns       325219 ns          432
+// bm_book_acc/1048576   29727473 ns     13714585 ns           11
+// bm_par_acc/1024            380 ns          379 ns       419412
+// bm_par_acc/32768         17001 ns        10582 ns        13258
+// bm_par_acc/1048576      395164 ns       218647 ns          658
+// Program ended with exit code: 0
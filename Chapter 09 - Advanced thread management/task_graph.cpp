@@ -0,0 +1,563 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+class join_threads {
+public:
+    explicit join_threads(std::vector<std::thread> &threads) : threads_(threads) { }
+
+    ~join_threads()
+    {
+        for (auto &t : threads_)
+            if (t.joinable()) { t.join(); }
+    }
+
+private:
+    std::vector<std::thread> &threads_;
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+class function_wrapper {
+public:
+    function_wrapper() = default;
+
+    function_wrapper(const function_wrapper&) = delete;
+    function_wrapper(function_wrapper&) = delete;
+    function_wrapper& operator=(const function_wrapper&) = delete;
+
+    function_wrapper(function_wrapper &&other) noexcept : impl_(std::move(other.impl_)) { }
+
+    function_wrapper& operator=(function_wrapper &&rhs) noexcept
+    {
+        impl_ = std::move(rhs.impl_);
+        return *this;
+    }
+
+    template <typename Func>
+    function_wrapper(Func &&f) noexcept : impl_(std::make_unique<impl_type<Func>>(std::move(f))) { }
+
+    void operator() () { impl_->call(); }
+
+
+private:
+    struct impl_base {
+        // abstract base class
+        virtual void call() = 0;
+        virtual ~impl_base() { }
+    };
+
+    std::unique_ptr<impl_base> impl_;
+
+    template <typename Func>
+    struct impl_type : impl_base {
+        Func f_;
+
+        impl_type(Func &&f) : f_(std::move(f)) { }
+        void call() { f_(); }
+    };
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+namespace ws {
+// same idea as work_stealing.cpp - the owner pushes and pops at the back (the newest task, so likely still in cache)...
+// ...and thieves take from the front - but in a ring buffer that only ever grows, instead of a std::deque that...
+// ...allocates and frees blocks as it goes, so once it's big enough, pushing never allocates
+template <typename T>
+class queue {
+public:
+    queue() { }
+
+    queue(const queue&) = delete;
+    queue& operator=(const queue&) = delete;
+
+    void push(T data) {
+        std::lock_guard<std::mutex> lock(m_);
+
+        if (size_ == buf_.size()) { grow(); }
+        buf_[(head_ + size_++) % buf_.size()] = std::move(data);
+    }
+
+    bool empty() const {
+        std::lock_guard<std::mutex> lock(m_);
+        return !size_;
+    }
+
+    bool try_pop(T &result) {
+        std::lock_guard<std::mutex> lock(m_);
+
+        if (!size_) { return false; }
+
+        result = std::move(buf_[(head_ + --size_) % buf_.size()]);
+        return true;
+    }
+
+    bool try_steal(T &result) {
+        std::lock_guard<std::mutex> lock(m_);
+
+        if (!size_) { return false; }
+
+        result = std::move(buf_[head_]);
+        head_ = (head_ + 1) % buf_.size();
+        --size_;
+        return true;
+    }
+private:
+    std::vector<T> buf_;
+    std::size_t head_ = 0, size_ = 0;
+    mutable std::mutex m_;
+
+    void grow() {
+        std::vector<T> bigger(std::max<std::size_t>(16, 2 * buf_.size()));
+        for (std::size_t i = 0; i != size_; ++i) { bigger[i] = std::move(buf_[(head_ + i) % buf_.size()]); }
+
+        buf_.swap(bigger);
+        head_ = 0;
+    }
+};
+} // namespace ws (work-stealing)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// a queue per worker, plus a shared one for anything pushed from outside the pool - a worker looks in its own queue...
+// ...first, then the shared one, then steals from everyone else's, and only goes to sleep once they're all empty
+// jobs are a function pointer and its arguments rather than a function_wrapper, so pushing one doesn't allocate either
+class work_stealing_pool {
+public:
+    struct job {
+        void (*run)(void *context, std::size_t index);
+        void *context;
+        std::size_t index;
+    };
+
+    explicit work_stealing_pool(std::size_t thread_count = default_thread_count()) : done_(false), joiner_(threads_)
+    {
+        for (std::size_t i = 0; i != thread_count; ++i) { queues_.push_back(std::make_unique<ws::queue<job>>()); }
+
+        try {
+            for (std::size_t i = 0; i != thread_count; ++i)
+                threads_.push_back(std::thread(&work_stealing_pool::worker_thread, this, i));
+        } catch (...) {
+            shutdown();
+            throw;
+        }
+    }
+
+    ~work_stealing_pool() { shutdown(); }
+
+    // onto our own queue if we're one of the workers, the shared one if not
+    void push(job j)
+    {
+        if (owner_ == this) {
+            queues_[index_]->push(j);
+        } else {
+            shared_q_.push(j);
+        }
+
+        // a sleeper bumps sleepers_ before it checks queued_, and we bump queued_ before we check sleepers_, so one of...
+        // ...us always sees the other - and taking the lock means it's either not asleep yet, or it'll get the notify
+        queued_.fetch_add(1);
+        if (sleepers_.load()) {
+            { std::lock_guard<std::mutex> lock(sleep_m_); }
+            sleep_cv_.notify_one();
+        }
+    }
+
+    // lets a thread that's waiting on the pool lend a hand - returns false if there was nothing to do
+    bool run_pending_task()
+    {
+        job j;
+
+        if (!(owner_ == this && queues_[index_]->try_pop(j)) && !shared_q_.try_steal(j) && !try_steal(j)) { return false; }
+
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        j.run(j.context, j.index);
+        return true;
+    }
+
+    std::size_t thread_count() const { return threads_.size(); }
+
+private:
+    std::atomic<bool> done_;
+
+    ws::queue<job> shared_q_;
+    std::vector<std::unique_ptr<ws::queue<job>>> queues_;
+
+    std::atomic<std::size_t> queued_ = 0, sleepers_ = 0;
+    std::mutex sleep_m_;
+    std::condition_variable sleep_cv_;
+
+    std::vector<std::thread> threads_;
+    join_threads joiner_;
+
+    // which pool (if any) this thread works for, and which queue is its own
+    static inline thread_local work_stealing_pool *owner_ = nullptr;
+    static inline thread_local std::size_t index_ = 0;
+
+    static std::size_t default_thread_count()
+    {
+        std::size_t hw_threads = std::thread::hardware_concurrency();
+        return hw_threads > 1 ? hw_threads - 1 : 1; // the caller makes up the numbers
+    }
+
+    // everybody else's queues, starting with the one after ours so the thieves don't all pick on the same victim
+    bool try_steal(job &j)
+    {
+        std::size_t start = owner_ == this ? index_ + 1 : 0;
+
+        for (std::size_t i = 0; i != queues_.size(); ++i) {
+            if (queues_[(start + i) % queues_.size()]->try_steal(j)) { return true; }
+        }
+
+        return false;
+    }
+
+    void worker_thread(std::size_t index)
+    {
+        owner_ = this;
+        index_ = index;
+
+        while (!done_) {
+            if (run_pending_task()) { continue; }
+
+            std::unique_lock<std::mutex> lock(sleep_m_);
+            sleepers_.fetch_add(1);
+            sleep_cv_.wait(lock, [&] () { return done_ || queued_.load(); });
+            sleepers_.fetch_sub(1);
+        }
+    }
+
+    void shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleep_m_);
+            done_ = true;
+        }
+
+        sleep_cv_.notify_all();
+    }
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// nodes are tasks, and an edge from a to b means b can't start until a's finished - build it once, run it as often as...
+// ...you like (running it allocates nothing - every node's counter is just reset from the dependencies it was built with)
+//   1) every node with no dependencies is pushed onto the pool
+//   2) when a node finishes, it counts down each of its successors - whoever takes one to zero has made it ready...
+//   3) ...and pushes it onto its own queue, except for the first one, which it just carries on and runs itself
+// no task ever waits for another, so no worker's ever stuck in a future's .get() while there's work to be done
+class task_graph {
+public:
+    typedef std::size_t node_id;
+
+    task_graph() = default;
+
+    task_graph(const task_graph&) = delete;
+    task_graph& operator=(const task_graph&) = delete;
+
+    template <typename Func>
+    node_id emplace(Func f)
+    {
+        nodes_.emplace_back(std::move(f));
+        checked_ = false;
+        return nodes_.size() - 1;
+    }
+
+    // after can't start until before's finished
+    void precede(node_id before, node_id after)
+    {
+        nodes_.at(before).successors.push_back(after);
+        ++nodes_.at(after).dependencies;
+        checked_ = false;
+    }
+
+    std::size_t size() const { return nodes_.size(); }
+
+    // runs every node, helping out until there's nothing left to pick up, then waiting for the stragglers - if any node...
+    // ...throws, nothing that hasn't started yet gets run, and the first exception is rethrown here
+    void run(work_stealing_pool &pool)
+    {
+        if (nodes_.empty()) { return; }
+        if (!checked_) { check(); }
+
+        for (auto &n : nodes_) { n.pending.store(n.dependencies, std::memory_order_relaxed); }
+
+        pool_ = &pool;
+        remaining_.store(nodes_.size(), std::memory_order_relaxed);
+        finished_ = false;
+        failed_.store(false, std::memory_order_relaxed);
+        error_ = nullptr;
+
+        for (node_id r : roots_) { pool.push({ &task_graph::run_node, this, r }); }
+
+        while (remaining_.load(std::memory_order_acquire) && pool.run_pending_task()) { }
+
+        // only finished_ (set under the lock) says the last node's done with us - remaining_ hits zero a moment earlier
+        {
+            std::unique_lock<std::mutex> lock(done_m_);
+            done_cv_.wait(lock, [&] () { return finished_; });
+        }
+
+        if (error_) { std::rethrow_exception(error_); }
+    }
+
+private:
+    struct node {
+        function_wrapper work;
+        std::vector<node_id> successors;
+        std::size_t dependencies = 0;
+        std::atomic<std::size_t> pending = 0;
+
+        template <typename Func>
+        explicit node(Func &&f) : work(std::move(f)) { }
+    };
+
+    std::deque<node> nodes_; // a deque, as the atomics can't be moved when a vector grows
+    std::vector<node_id> roots_;
+    bool checked_ = false;
+
+    work_stealing_pool *pool_ = nullptr;
+    std::atomic<std::size_t> remaining_ = 0;
+
+    std::atomic<bool> failed_ = false;
+    std::exception_ptr error_;
+
+    std::mutex done_m_;
+    std::condition_variable done_cv_;
+    bool finished_ = false;
+
+    // Kahn's algorithm, once per change to the graph - finds the roots, and makes sure there isn't a cycle (which would...
+    // ...leave run() waiting forever on nodes that can never become ready)
+    void check()
+    {
+        roots_.clear();
+        std::vector<std::size_t> pending(nodes_.size());
+        std::vector<node_id> ready;
+
+        for (node_id i = 0; i != nodes_.size(); ++i) {
+            pending[i] = nodes_[i].dependencies;
+            if (!pending[i]) { roots_.push_back(i); }
+        }
+
+        ready = roots_;
+        std::size_t visited = 0;
+
+        while (!ready.empty()) {
+            node_id i = ready.back();
+            ready.pop_back();
+            ++visited;
+
+            for (node_id s : nodes_[i].successors) {
+                if (!--pending[s]) { ready.push_back(s); }
+            }
+        }
+
+        if (visited != nodes_.size()) { throw std::logic_error("task_graph has a cycle"); }
+        checked_ = true;
+    }
+
+    static void run_node(void *context, std::size_t id)
+    {
+        task_graph &graph = *static_cast<task_graph*>(context);
+
+        while (true) {
+            node &n = graph.nodes_[id];
+
+            if (!graph.failed_.load(std::memory_order_relaxed)) {
+                try {
+                    n.work();
+                } catch (...) {
+                    if (!graph.failed_.exchange(true)) { graph.error_ = std::current_exception(); }
+                }
+            }
+
+            // acq_rel - whoever takes a successor to zero has to see what every one of its predecessors wrote
+            node_id next = 0;
+            bool has_next = false;
+
+            for (node_id s : n.successors) {
+                if (graph.nodes_[s].pending.fetch_sub(1, std::memory_order_acq_rel) != 1) { continue; }
+
+                if (!has_next) {
+                    next = s;
+                    has_next = true;
+                } else {
+                    graph.pool_->push({ &task_graph::run_node, context, s });
+                }
+            }
+
+            // the last node out tells run() - and nobody touches the graph after this, as it may already be gone...
+            // ...apart from to run next, which hasn't run yet, so this can't have been the last node
+            if (graph.remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(graph.done_m_);
+                graph.finished_ = true;
+                graph.done_cv_.notify_all();
+                return;
+            }
+
+            if (!has_next) { return; }
+            id = next;
+        }
+    }
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// a layered graph - every node depends on two in the layer before it, and does a few microseconds' worth of sums
+constexpr std::size_t width = 64, depth = 64;
+
+std::uint64_t busy_work(std::uint64_t seed) {
+    for (int i = 0; i != 2000; ++i) { seed = seed * 6364136223846793005u + 1442695040888963407u; }
+    return seed;
+}
+
+static void bm_sequential(benchmark::State &state) {
+    std::vector<std::uint64_t> results(width * depth);
+
+    for (auto _ : state) {
+        for (std::size_t i = 0; i != results.size(); ++i) { results[i] = busy_work(i); }
+        benchmark::DoNotOptimize(results.data());
+    }
+} BENCHMARK(bm_sequential)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// what we'd have had to do before - every node's a task that blocks on its predecessors' futures before it starts
+static void bm_blocking_futures(benchmark::State &state) {
+    work_stealing_pool pool;
+    std::vector<std::uint64_t> results(width * depth);
+
+    struct context {
+        std::vector<std::promise<void>> done;
+        std::vector<std::shared_future<void>> ready;
+        std::vector<std::uint64_t> *results;
+    };
+
+    for (auto _ : state) {
+        context c { std::vector<std::promise<void>>(width * depth), { }, &results };
+        for (auto &p : c.done) { c.ready.push_back(p.get_future().share()); }
+
+        // pushed in order, so a node's predecessors are always ahead of it in the queue
+        for (std::size_t i = 0; i != width * depth; ++i) {
+            pool.push({ [] (void *ctx, std::size_t node) {
+                auto &nodes = *static_cast<context*>(ctx);
+
+                if (node >= width) {
+                    nodes.ready[node - width].wait();
+                    nodes.ready[(node + 1) % width + (node / width - 1) * width].wait();
+                }
+
+                (*nodes.results)[node] = busy_work(node);
+                nodes.done[node].set_value();
+            }, &c, i });
+        }
+
+        for (auto &f : c.ready) { while (f.wait_for(std::chrono::seconds(0)) != std::future_status::ready && pool.run_pending_task()); f.wait(); }
+        benchmark::DoNotOptimize(results.data());
+    }
+} BENCHMARK(bm_blocking_futures)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void bm_task_graph(benchmark::State &state) {
+    work_stealing_pool pool;
+    std::vector<std::uint64_t> results(width * depth);
+
+    task_graph graph;
+    for (std::size_t i = 0; i != width * depth; ++i) { graph.emplace([&results, i] () { results[i] = busy_work(i); }); }
+
+    for (std::size_t i = width; i != width * depth; ++i) {
+        graph.precede(i - width, i);
+        graph.precede((i + 1) % width + (i / width - 1) * width, i);
+    }
+
+    for (auto _ : state) {
+        graph.run(pool);
+        benchmark::DoNotOptimize(results.data());
+    }
+} BENCHMARK(bm_task_graph)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int main(int argc, char **argv)
+{
+    work_stealing_pool pool;
+
+    // a little build - both objects need the source fetching first, and linking needs both objects
+    std::mutex cout_m;
+    auto step = [&] (std::string name) {
+        return [&cout_m, name] () { std::lock_guard lock(cout_m); std::cout << name << '\n'; };
+    };
+
+    task_graph build;
+    auto fetch = build.emplace(step("fetch sources"));
+    auto compile_a = build.emplace(step("  compile a.o"));
+    auto compile_b = build.emplace(step("  compile b.o"));
+    auto link = build.emplace(step("    link"));
+
+    build.precede(fetch, compile_a);
+    build.precede(fetch, compile_b);
+    build.precede(compile_a, link);
+    build.precede(compile_b, link);
+
+    build.run(pool);
+    std::cout << "...and again, without rebuilding the graph\n";
+    build.run(pool);
+
+    // an exception stops anything that hasn't started yet, and comes back out of run()
+    task_graph failing;
+    auto first = failing.emplace([] () { throw std::runtime_error("compile error"); });
+    auto never = failing.emplace([] () { std::cout << "never runs\n"; });
+    failing.precede(first, never);
+
+    try { failing.run(pool); } catch (const std::exception &e) { std::cout << "\ncaught: " << e.what() << '\n'; }
+
+    failing.precede(never, first);
+    try { failing.run(pool); } catch (const std::exception &e) { std::cout << "caught: " << e.what() << "\n\n"; }
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//  OUTPUT - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// fetch sources
+//   compile a.o
+//   compile b.o
+//     link
+// ...and again, without rebuilding the graph
+// fetch sources
+//   compile a.o
+//   compile b.o
+//     link
+//
+// caught: compile error
+// caught: task_graph has a cycle
+//
+// Run on (1 X 2100 MHz CPU )
+// CPU Caches:
+//   L1 Data 48 KiB (x1)
+//   L1 Instruction 32 KiB (x1)
+//   L2 Unified 2048 KiB (x1)
+//   L3 Unified 307200 KiB (x1)
+// Load Average: 0.43, 0.67, 0.79
+// ------------------------------------------------------------------------
+// Benchmark                              Time             CPU   Iterations
+// ------------------------------------------------------------------------
+// bm_sequential/real_time             11.4 ms         11.3 ms           63
+// bm_blocking_futures/real_time       13.2 ms         6.67 ms           54
+// bm_task_graph/real_time             11.4 ms         5.50 ms           60
+// Program ended with exit code: 0
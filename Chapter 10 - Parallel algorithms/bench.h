@@ -0,0 +1,63 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+// what the Chapter 10 benchmarks have in common - the same call going to std:: or par:: depending on the policy, the same...
+// ...set of policies for every benchmark, and the same (seeded) random input
+
+#include <benchmark/benchmark.h>
+
+#include <execution>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include "par.h"
+
+// std:: for the std::execution policies, par:: for ours - same arguments either way
+#define CALL(algorithm, policy, ...)                                                          \
+    [&] () {                                                                                  \
+        if constexpr (std::is_execution_policy_v<std::remove_cvref_t<decltype(policy)>>) {   \
+            return std::algorithm(policy, __VA_ARGS__);                                       \
+        } else {                                                                              \
+            return par::algorithm(policy, __VA_ARGS__);                                       \
+        }                                                                                     \
+    } ()
+
+// bm with std::execution::seq, std::execution::par (which GCC hands off to TBB, so link with -ltbb) and par::execution::par
+// BENCH_ARGS is the rest of the chain (e.g. ->Arg(1 << 16)->UseRealTime()) - every file #defines its own before using these
+#define REGISTER(bm)                                                                          \
+    BENCHMARK_CAPTURE(bm, std_seq, std::execution::seq) BENCH_ARGS;                           \
+    BENCHMARK_CAPTURE(bm, std_par, std::execution::par) BENCH_ARGS;                           \
+    BENCHMARK_CAPTURE(bm, par_par, par::execution::par) BENCH_ARGS
+
+// ...and with par::execution::par_unseq as well
+#define REGISTER_WITH_PAR_UNSEQ(bm)                                                           \
+    REGISTER(bm);                                                                             \
+    BENCHMARK_CAPTURE(bm, par_par_unseq, par::execution::par_unseq) BENCH_ARGS
+
+// ...or without std::execution::par, for the algorithms where that doesn't compile
+#define REGISTER_WITHOUT_STD_PAR(bm)                                                          \
+    BENCHMARK_CAPTURE(bm, std_seq, std::execution::seq) BENCH_ARGS;                           \
+    BENCHMARK_CAPTURE(bm, par_par, par::execution::par) BENCH_ARGS
+
+namespace bench {
+// n Ts, uniformly spread over [lo, hi] ([lo, hi) for floating point) - seeded, so every run gets the same input
+template <typename T>
+std::vector<T> make_input(std::size_t n, std::type_identity_t<T> lo, std::type_identity_t<T> hi, unsigned seed = 42) {
+    std::vector<T> tvec(n);
+
+    std::mt19937 e(seed);
+
+    if constexpr (std::is_floating_point_v<T>) {
+        std::uniform_real_distribution<T> u(lo, hi);
+        for (auto &t : tvec) { t = u(e); }
+    } else {
+        std::uniform_int_distribution<T> u(lo, hi);
+        for (auto &t : tvec) { t = u(e); }
+    }
+
+    return tvec;
+}
+} // namespace bench
+
+#endif // BENCH_H
@@ -0,0 +1,140 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "par.h"
+
+std::vector<std::uint32_t> make_input(std::size_t n, std::uint32_t domain) { return bench::make_input<std::uint32_t>(n, 0, domain - 1); }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// range(0) is the number of bins
+static void bm_seq_histogram(benchmark::State &state) {
+    auto uvec = make_input(1 << 22, state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(par::histogram(par::execution::seq, uvec.begin(), uvec.end(), state.range(0)));
+    }
+} BENCHMARK(bm_seq_histogram)->Arg(256)->Arg(1 << 16)->UseRealTime();
+
+// what we'd have written with par_for_each.cpp - every thread hammering the same counters
+static void bm_shared_atomics(benchmark::State &state) {
+    auto uvec = make_input(1 << 22, state.range(0));
+    for (auto _ : state) {
+        std::vector<std::atomic<std::size_t>> counts(state.range(0));
+        par::for_each(par::execution::par, uvec.begin(), uvec.end(), [&] (std::uint32_t i) {
+            counts[i].fetch_add(1, std::memory_order_relaxed);
+        });
+        benchmark::DoNotOptimize(counts.data());
+    }
+} BENCHMARK(bm_shared_atomics)->Arg(256)->Arg(1 << 16)->UseRealTime();
+
+static void bm_par_histogram(benchmark::State &state) {
+    auto uvec = make_input(1 << 22, state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(par::histogram(par::execution::par, uvec.begin(), uvec.end(), state.range(0)));
+    }
+} BENCHMARK(bm_par_histogram)->Arg(256)->Arg(1 << 16)->UseRealTime();
+
+// range(0) is how many distinct keys there are (out of the whole 32-bit range)
+static void bm_seq_count_by_key(benchmark::State &state) {
+    auto keys = make_input(1 << 22, -1);
+    for (auto &k : keys) { k = k % state.range(0) * 2654435761u; } // spread the keys across the range
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(par::count_by_key(par::execution::seq, keys.begin(), keys.end()));
+    }
+} BENCHMARK(bm_seq_count_by_key)->Arg(1 << 10)->Arg(1 << 18)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void bm_par_count_by_key(benchmark::State &state) {
+    auto keys = make_input(1 << 22, -1);
+    for (auto &k : keys) { k = k % state.range(0) * 2654435761u; }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(par::count_by_key(par::execution::par, keys.begin(), keys.end()));
+    }
+} BENCHMARK(bm_par_count_by_key)->Arg(1 << 10)->Arg(1 << 18)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int main(int argc, char **argv)
+{
+    // a million normally-distributed doubles in 12 bins of width 0.5, from -3 to +3 (anything further out is clamped)
+    std::vector<double> dvec(1 << 20);
+
+    std::mt19937 e(42);
+    std::normal_distribution<double> n;
+    for (auto &d : dvec) { d = n(e); }
+
+    auto bin_of = [] (double d) { return std::clamp(static_cast<int>((d + 3.0) * 2.0), 0, 11); };
+    auto counts = par::histogram(par::execution::par, dvec.begin(), dvec.end(), 12, bin_of);
+
+    for (std::size_t k = 0; k != counts.size(); ++k) {
+        std::cout << std::setw(5) << -3.0 + k * 0.5 << ' ' << std::setw(7) << counts[k] << ' ' << std::string(counts[k] / 4000, '*') << '\n';
+    }
+
+    // and against a plain loop, on something big enough to be split up
+    auto uvec = make_input(1 << 22, 1 << 16);
+    std::vector<std::size_t> expected(1 << 16);
+    for (auto u : uvec) { ++expected[u]; }
+
+    std::cout << "\nhistogram:    " << (par::histogram(par::execution::par, uvec.begin(), uvec.end(), 1 << 16) == expected ? "matches" : "DOESN'T match") << '\n';
+
+    auto by_key = par::count_by_key(par::execution::par, uvec.begin(), uvec.end());
+    bool keys_match = by_key.size() == std::size_t(std::count_if(expected.begin(), expected.end(), [] (std::size_t c) { return c; }));
+    for (auto &[key, count] : by_key) { keys_match = keys_match && expected[key] == count; }
+    std::cout << "count_by_key: " << (keys_match ? "matches" : "DOESN'T match") << "\n\n";
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//  OUTPUT - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+//    -3    6588 *
+//  -2.5   17319 ****
+//    -2   46014 ***********
+//  -1.5   96405 ************************
+//    -1  156899 ***************************************
+//  -0.5  200674 **************************************************
+//     0  201173 **************************************************
+//   0.5  156974 ***************************************
+//     1   95978 ***********************
+//   1.5   46374 ***********
+//     2   17555 ****
+//   2.5    6623 *
+//
+// histogram:    matches
+// count_by_key: matches
+//
+// Run on (1 X 2100 MHz CPU )
+// CPU Caches:
+//   L1 Data 48 KiB (x1)
+//   L1 Instruction 32 KiB (x1)
+//   L2 Unified 2048 KiB (x1)
+//   L3 Unified 307200 KiB (x1)
+// Load Average: 0.64, 0.85, 0.82
+// -------------------------------------------------------------------------------
+// Benchmark                                     Time             CPU   Iterations
+// -------------------------------------------------------------------------------
+// bm_seq_histogram/256/real_time          2392135 ns      2375375 ns          213
+// bm_seq_histogram/65536/real_time        5349221 ns      5185249 ns           77
+// bm_shared_atomics/256/real_time        30464519 ns     15237025 ns           10
+// bm_shared_atomics/65536/real_time      26831243 ns     13240651 ns           16
+// bm_par_histogram/256/real_time          2369006 ns      1296622 ns          193
+// bm_par_histogram/65536/real_time        6123323 ns      3097686 ns           72
+// bm_seq_count_by_key/1024/real_time         40.4 ms         39.6 ms            9
+// bm_seq_count_by_key/262144/real_time        147 ms          146 ms            3
+// bm_par_count_by_key/1024/real_time         48.0 ms         23.9 ms           11
+// bm_par_count_by_key/262144/real_time        229 ms          129 ms            2
+// Program ended with exit code: 0
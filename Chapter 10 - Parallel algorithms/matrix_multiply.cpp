@@ -0,0 +1,167 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "par.h"
+
+std::vector<double> make_matrix(std::size_t rows, std::size_t cols, unsigned seed) {
+    std::vector<double> m(rows * cols);
+
+    std::mt19937 e(seed);
+    std::uniform_real_distribution<double> u(-1.0, 1.0);
+    for (auto &d : m) { d = u(e); }
+
+    return m;
+}
+
+// the textbook triple loop - walks down a column of b for every element of c, so every b access is a new cache line
+void naive_gemm(std::size_t m, std::size_t n, std::size_t k, const double *a, const double *b, double *c) {
+    for (std::size_t i = 0; i != m; ++i) {
+        for (std::size_t j = 0; j != n; ++j) {
+            double sum = 0.0;
+            for (std::size_t p = 0; p != k; ++p) { sum += a[i * k + p] * b[p * n + j]; }
+            c[i * n + j] = sum;
+        }
+    }
+}
+
+// loop interchange - the inner loop runs along rows of b and c instead, but nothing's blocked for the cache
+void interchanged_gemm(std::size_t m, std::size_t n, std::size_t k, const double *a, const double *b, double *c) {
+    std::fill(c, c + m * n, 0.0);
+
+    for (std::size_t i = 0; i != m; ++i) {
+        for (std::size_t p = 0; p != k; ++p) {
+            double a_ip = a[i * k + p];
+            for (std::size_t j = 0; j != n; ++j) { c[i * n + j] += a_ip * b[p * n + j]; }
+        }
+    }
+}
+
+void naive_transpose(std::size_t m, std::size_t n, const double *in, double *out) {
+    for (std::size_t i = 0; i != m; ++i) {
+        for (std::size_t j = 0; j != n; ++j) { out[j * m + i] = in[i * n + j]; }
+    }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// range(0) is n, for n x n matrices - reported in FLOP/s (2n^3 per multiply)
+template <typename Gemm>
+void bm_gemm(benchmark::State &state, Gemm gemm) {
+    std::size_t n = state.range(0);
+    auto a = make_matrix(n, n, 1), b = make_matrix(n, n, 2), c = make_matrix(n, n, 3);
+
+    for (auto _ : state) {
+        gemm(n, n, n, a.data(), b.data(), c.data());
+        benchmark::DoNotOptimize(c.data());
+    }
+
+    state.counters["FLOP/s"] = benchmark::Counter(2.0 * n * n * n, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void bm_naive_gemm(benchmark::State &state) {
+    bm_gemm(state, naive_gemm);
+} BENCHMARK(bm_naive_gemm)->Arg(256)->Arg(1024)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void bm_interchanged_gemm(benchmark::State &state) {
+    bm_gemm(state, interchanged_gemm);
+} BENCHMARK(bm_interchanged_gemm)->Arg(256)->Arg(1024)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void bm_seq_gemm(benchmark::State &state) {
+    bm_gemm(state, [] (auto... args) { par::gemm(par::execution::seq, args...); });
+} BENCHMARK(bm_seq_gemm)->Arg(256)->Arg(1024)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void bm_par_gemm(benchmark::State &state) {
+    bm_gemm(state, [] (auto... args) { par::gemm(par::execution::par, args...); });
+} BENCHMARK(bm_par_gemm)->Arg(256)->Arg(1024)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// range(0) is n, for an n x n matrix - reported in bytes/s (read once, written once)
+template <typename Transpose>
+void bm_transpose(benchmark::State &state, Transpose transpose) {
+    std::size_t n = state.range(0);
+    auto in = make_matrix(n, n, 1), out = make_matrix(n, n, 2);
+
+    for (auto _ : state) {
+        transpose(n, n, in.data(), out.data());
+        benchmark::DoNotOptimize(out.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * 2 * n * n * sizeof(double));
+}
+
+static void bm_naive_transpose(benchmark::State &state) {
+    bm_transpose(state, naive_transpose);
+} BENCHMARK(bm_naive_transpose)->Arg(256)->Arg(4096)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void bm_seq_transpose(benchmark::State &state) {
+    bm_transpose(state, [] (auto... args) { par::transpose(par::execution::seq, args...); });
+} BENCHMARK(bm_seq_transpose)->Arg(256)->Arg(4096)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void bm_par_transpose(benchmark::State &state) {
+    bm_transpose(state, [] (auto... args) { par::transpose(par::execution::par, args...); });
+} BENCHMARK(bm_par_transpose)->Arg(256)->Arg(4096)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int main(int argc, char **argv)
+{
+    // odd sizes, so every edge case in the tiling gets hit
+    std::size_t m = 301, n = 257, k = 515;
+    auto a = make_matrix(m, k, 1), b = make_matrix(k, n, 2);
+    std::vector<double> expected(m * n), c(m * n);
+
+    naive_gemm(m, n, k, a.data(), b.data(), expected.data());
+    par::gemm(par::execution::par, m, n, k, a.data(), b.data(), c.data());
+
+    double max_error = 0.0;
+    for (std::size_t i = 0; i != c.size(); ++i) { max_error = std::max(max_error, std::abs(c[i] - expected[i])); }
+    std::cout << "gemm:      " << m << " x " << k << " * " << k << " x " << n << ", largest difference from naive_gemm: " << max_error << '\n';
+
+    std::vector<double> t(m * n), t2(m * n);
+    naive_transpose(m, n, c.data(), t.data());
+    par::transpose(par::execution::par, m, n, c.data(), t2.data());
+    std::cout << "transpose: " << (t == t2 ? "matches" : "DOESN'T match") << " naive_transpose\n\n";
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//  OUTPUT - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// gemm:      301 x 515 * 515 x 257, largest difference from naive_gemm: 6.03961e-14
+// transpose: matches naive_transpose
+//
+// Run on (1 X 2100 MHz CPU )
+// CPU Caches:
+//   L1 Data 48 KiB (x1)
+//   L1 Instruction 32 KiB (x1)
+//   L2 Unified 2048 KiB (x1)
+//   L3 Unified 307200 KiB (x1)
+// Load Average: 0.44, 0.83, 0.85
+// ----------------------------------------------------------------------------------------------
+// Benchmark                                    Time             CPU   Iterations UserCounters...
+// ----------------------------------------------------------------------------------------------
+// bm_naive_gemm/256/real_time               18.9 ms         18.5 ms           38 FLOP/s=1.77965G/s
+// bm_naive_gemm/1024/real_time              4830 ms         4793 ms            1 FLOP/s=444.598M/s
+// bm_interchanged_gemm/256/real_time        8.86 ms         8.80 ms           72 FLOP/s=3.788G/s
+// bm_interchanged_gemm/1024/real_time        602 ms          599 ms            1 FLOP/s=3.56479G/s
+// bm_seq_gemm/256/real_time                 3.75 ms         3.69 ms          245 FLOP/s=8.94377G/s
+// bm_seq_gemm/1024/real_time                 181 ms          180 ms            4 FLOP/s=11.8563G/s
+// bm_par_gemm/256/real_time                 2.91 ms         1.54 ms          251 FLOP/s=11.5329G/s
+// bm_par_gemm/1024/real_time                 223 ms          111 ms            4 FLOP/s=9.64435G/s
+// bm_naive_transpose/256/real_time         0.230 ms        0.227 ms         3072 bytes_per_second=4.23917G/s
+// bm_naive_transpose/4096/real_time          208 ms          207 ms            3 bytes_per_second=1.20131G/s
+// bm_seq_transpose/256/real_time           0.055 ms        0.053 ms        12100 bytes_per_second=17.8918G/s
+// bm_seq_transpose/4096/real_time            108 ms          107 ms            6 bytes_per_second=2.30617G/s
+// bm_par_transpose/256/real_time           0.064 ms        0.039 ms        11629 bytes_per_second=15.1754G/s
+// bm_par_transpose/4096/real_time           98.1 ms         50.1 ms            7 bytes_per_second=2.54893G/s
+// Program ended with exit code: 0
@@ -0,0 +1,1547 @@
+#ifndef PAR_H
+#define PAR_H
+
+// the par:: algorithms from Chapters 2, 4, 8 and 9, gathered into one header - every one takes an execution policy...
+// ...like its std:: namesake, and they all share one long-lived thread pool rather than starting threads of their own
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// "these iterations don't depend on each other" - lets the compiler vectorise a par_unseq loop without proving it itself
+#if defined(__clang__)
+#define PAR_IVDEP _Pragma("clang loop vectorize(assume_safety)")
+#elif defined(__GNUC__)
+#define PAR_IVDEP _Pragma("GCC ivdep")
+#else
+#define PAR_IVDEP
+#endif
+
+// "unroll this fixed-length loop all the way"
+#if defined(__clang__)
+#define PAR_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__)
+#define PAR_UNROLL _Pragma("GCC unroll 64")
+#else
+#define PAR_UNROLL
+#endif
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+namespace mt {
+template <typename T>
+class queue {
+public:
+    queue() : head_(std::make_unique<node>()), tail_(head_.get()) { }
+    
+    queue(const queue&) = delete;
+    queue& operator=(const queue&) = delete;
+    
+    std::shared_ptr<T> try_pop()
+    {
+        std::unique_ptr<node> old_head = try_pop_head();
+        return old_head ? old_head->data_ : std::shared_ptr<T>();
+    }
+    
+    bool try_pop(T &val)
+    {
+        std::unique_ptr<node> old_head = try_pop_head(val);
+        return old_head.get();
+    }
+    
+    std::shared_ptr<T> wait_and_pop()
+    {
+        std::unique_ptr<node> old_head = wait_pop_head();
+        return old_head->data_;
+    }
+    
+    void wait_and_pop(T &val)
+    {
+        std::unique_ptr<node> old_head = wait_pop_head(val);
+    }
+    
+    // as above, but gives up (and returns false) as soon as a stop's requested through st
+    bool wait_and_pop(T &val, std::stop_token st)
+    {
+        std::unique_lock<std::mutex> lock(head_m);
+        if (!cv.wait(lock, st, [&] () { return head_.get() != get_tail(); })) { return false; }
+        
+        val = std::move(*head_->data_);
+        pop_head();
+        
+        return true;
+    }
+    
+    template <typename V>
+    void push(V &&val)
+    {
+        auto new_data = std::make_shared<T>(std::forward<V>(val));
+        auto p = std::make_unique<node>();
+        
+        {
+            std::lock_guard lock(tail_m);
+            tail_->data_ = new_data;
+            node *new_tail = p.get();
+            tail_->next_ = std::move(p);
+            tail_ = new_tail;
+        }
+        
+        cv.notify_one();
+    }
+    
+    bool empty() const
+    {
+        std::lock_guard lock(head_m);
+        return head_.get() == get_tail();
+    }
+    
+private:
+    struct node
+    {
+        std::shared_ptr<T> data_;
+        std::unique_ptr<node> next_;
+    };
+    
+    std::unique_ptr<node> pop_head()
+    {
+        std::unique_ptr<node> old_head = std::move(head_);
+        head_ = std::move(old_head->next_);
+        return old_head;
+    }
+    
+    std::unique_lock<std::mutex> wait_for_data()
+    {
+        std::unique_lock<std::mutex> lock(head_m);
+        cv.wait(lock, [&] () { return head_.get() != get_tail(); } );
+        return lock;
+    }
+    
+    std::unique_ptr<node> wait_pop_head()
+    {
+        std::unique_lock<std::mutex> lock(wait_for_data());
+        return pop_head();
+    }
+    
+    std::unique_ptr<node> wait_pop_head(T &val)
+    {
+        std::unique_lock<std::mutex> lock(wait_for_data());
+        val = std::move(*head_->data_);
+        return pop_head();;
+    }
+    
+    node* get_tail() const
+    {
+        std::lock_guard lock(tail_m);
+        return tail_;
+    }
+    
+    std::unique_ptr<node> try_pop_head()
+    {
+        std::lock_guard lock(head_m);
+        if (head_.get() == get_tail()) { return std::unique_ptr<node>(); }
+        return pop_head();
+    }
+    
+    std::unique_ptr<node> try_pop_head(T &val)
+    {
+        std::lock_guard lock(head_m);
+        if (head_.get() == get_tail()) { return std::unique_ptr<node>(); }
+        val = std::move(*head_->data_);
+        return pop_head();
+    }
+    
+    std::unique_ptr<node> head_;
+    node *tail_;
+    
+    mutable std::mutex head_m;
+    mutable std::mutex tail_m;
+    
+    std::condition_variable_any cv; // _any, for the waits that take a std::stop_token
+};
+} // namespace mt (multi-threaded)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+class function_wrapper {
+public:
+    function_wrapper() = default;
+    
+    function_wrapper(const function_wrapper&) = delete;
+    function_wrapper(function_wrapper&) = delete;
+    function_wrapper& operator=(const function_wrapper&) = delete;
+    
+    function_wrapper(function_wrapper &&other) noexcept : impl_(std::move(other.impl_)) { }
+    
+    function_wrapper& operator=(function_wrapper &&rhs) noexcept
+    {
+        impl_ = std::move(rhs.impl_);
+        return *this;
+    }
+    
+    template <typename Func>
+    // function_wrapper(Func &&f) : impl_(new impl_type<Func>(std::move(f))) { }
+    function_wrapper(Func &&f) noexcept : impl_(std::make_unique<impl_type<Func>>(std::move(f))) { }
+    
+    void operator() () { impl_->call(); }
+    
+    
+private:
+    struct impl_base {
+        // abstract base class
+        virtual void call() = 0;
+        virtual ~impl_base() { }
+    };
+    
+    std::unique_ptr<impl_base> impl_;
+    
+    template <typename Func>
+    struct impl_type : impl_base {
+        Func f_;
+        
+        impl_type(Func &&f) : f_(std::move(f)) { }
+        void call() { f_(); }
+    };
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+namespace par {
+// thrown out of anything that's cancelled before it finishes - whatever it was writing to is left half-written
+struct operation_cancelled : std::exception {
+    const char* what() const noexcept override { return "operation cancelled"; }
+};
+
+namespace detail {
+// std::hardware_destructive_interference_size can change with -mtune, which GCC (rightly) warns about in a header
+inline constexpr std::size_t cache_line_size = 64;
+
+inline std::stop_token& current_stop_token() {
+    thread_local std::stop_token token;
+    return token;
+}
+} // namespace detail
+
+// every par:: algorithm run on this thread while a stop_scope's alive (and every task it hands to the pool) keeps an...
+// ...eye on token - once a stop's requested, tasks that haven't started are skipped, and the algorithm throws...
+// ...operation_cancelled. only the loops that go through for_each_chunk() (for_each, transform, the reductions,...
+// ...partial_sort_top_k and sort's counting pass) give up part-way through a block - everything else finishes the...
+// ...blocks it's already started
+class stop_scope {
+public:
+    explicit stop_scope(std::stop_token token) : previous_(std::exchange(detail::current_stop_token(), std::move(token))) { }
+    ~stop_scope() { detail::current_stop_token() = std::move(previous_); }
+    
+    stop_scope(const stop_scope&) = delete;
+    stop_scope& operator=(const stop_scope&) = delete;
+    
+private:
+    std::stop_token previous_;
+};
+} // namespace par
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// long-lived pool from pooled_accumulate.cpp - idle workers block in wait_and_pop(), so keeping one around is free
+// the workers are std::jthreads, so shutting down is just a stop request, which wakes them straight out of their wait
+class thread_pool {
+public:
+    explicit thread_pool(std::size_t thread_count = default_thread_count())
+    {
+        for (std::size_t i = 0; i != thread_count; ++i)
+            threads_.emplace_back([this] (std::stop_token st) { worker_thread(st); });
+    }
+    
+    // f runs under an empty stop_scope, whoever ends up running it - a thread that's helping out while it waits on...
+    // ...something of its own mustn't lend f its stop token as well
+    template <typename Func>
+    std::future<std::invoke_result_t<Func&&>> submit(Func f)
+    {
+        typedef std::invoke_result_t<Func&&> T;
+        
+        std::packaged_task<T()> task([f = std::move(f)] () mutable -> T {
+            par::stop_scope uncancellable { std::stop_token() };
+            return std::move(f)();
+        });
+        std::future<T> result(task.get_future());
+        workq_.push(std::move(task));
+        
+        return result;
+    }
+    
+    // a task that can be cancelled - if st's stopped before it starts, it never runs (the future throws...
+    // ...par::operation_cancelled instead), and while it runs, any par:: algorithm inside it can be cancelled through st
+    // f can take the std::stop_token itself, if it's got long loops of its own to check it in
+    template <typename Func>
+    auto submit(std::stop_token st, Func f)
+    {
+        return submit([st, f = std::move(f)] () mutable {
+            if (st.stop_requested()) { throw par::operation_cancelled(); }
+            
+            par::stop_scope scope(st);
+            if constexpr (std::is_invocable_v<Func&, std::stop_token>) { return f(st); } else { return f(); }
+        });
+    }
+    
+    // lets a thread that's waiting on the pool lend a hand - returns false if there was nothing to do
+    // (every task brings its own stop_scope, so whatever the helper's cancelled by stays with the helper)
+    bool run_pending_task()
+    {
+        function_wrapper task;
+        if (!workq_.try_pop(task)) { return false; }
+        task();
+        return true;
+    }
+    
+    std::size_t thread_count() const { return threads_.size(); }
+    
+private:
+    mt::queue<function_wrapper> workq_;
+    
+    std::vector<std::jthread> threads_; // after workq_, so they're stopped and joined before it goes
+    
+    static std::size_t default_thread_count()
+    {
+        std::size_t hw_threads = std::thread::hardware_concurrency();
+        return hw_threads > 1 ? hw_threads - 1 : 1; // the caller makes up the numbers
+    }
+    
+    void worker_thread(std::stop_token st)
+    {
+        while (true) {
+            function_wrapper task;
+            if (!workq_.wait_and_pop(task, st)) { return; }
+            task();
+        }
+    }
+};
+
+// created on first use, joined at exit
+inline thread_pool& shared_pool() {
+    static thread_pool pool;
+    return pool;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+namespace par {
+namespace execution {
+// same idea as std::execution - the policy only says what the algorithm is *allowed* to do with the element accesses
+//   seq       - one thread, in order (we just call the std:: algorithm)
+//   par       - spread across the shared pool, in order within each block
+//   par_unseq - as par, but the accesses within a block may also be interleaved, so the inner loops can be vectorised
+struct sequenced_policy { };
+struct parallel_policy { };
+struct parallel_unsequenced_policy { };
+
+inline constexpr sequenced_policy seq{};
+inline constexpr parallel_policy par{};
+inline constexpr parallel_unsequenced_policy par_unseq{};
+
+template <typename T> struct is_execution_policy : std::false_type { };
+template <> struct is_execution_policy<sequenced_policy> : std::true_type { };
+template <> struct is_execution_policy<parallel_policy> : std::true_type { };
+template <> struct is_execution_policy<parallel_unsequenced_policy> : std::true_type { };
+
+template <typename T>
+inline constexpr bool is_execution_policy_v = is_execution_policy<std::remove_cvref_t<T>>::value;
+} // namespace execution
+
+namespace detail {
+template <typename _ExecutionPolicy>
+concept policy = execution::is_execution_policy_v<_ExecutionPolicy>;
+
+// only bother the pool if the policy allows it and we can jump straight to any block
+template <typename _ExecutionPolicy, typename... _Iterators>
+inline constexpr bool parallel = !std::is_same_v<std::remove_cvref_t<_ExecutionPolicy>, execution::sequenced_policy>
+                              && (std::random_access_iterator<_Iterators> && ...);
+
+template <typename _ExecutionPolicy>
+inline constexpr bool unsequenced = std::is_same_v<std::remove_cvref_t<_ExecutionPolicy>, execution::parallel_unsequenced_policy>;
+
+// below this many elements per block, handing a block to another thread costs more than it saves
+constexpr std::size_t min_per_block = 1 << 14;
+
+// one block per thread (the caller included), never smaller than min_per_block - the last block takes the remainder
+struct blocks {
+    std::size_t count, size, length;
+
+    explicit blocks(std::size_t n, std::size_t threads = shared_pool().thread_count() + 1)
+        : count(std::max<std::size_t>(1, std::min(threads, n / min_per_block))), size(n / count), length(n) { }
+
+    std::size_t begin(std::size_t b) const { return b * size; }
+    std::size_t end(std::size_t b) const { return b == count - 1 ? length : (b + 1) * size; }
+};
+
+// how often a long loop checks whether it's been cancelled - about as long as min_per_block, so a few microseconds
+constexpr std::size_t check_every = 1 << 14;
+
+inline bool stop_requested() { return current_stop_token().stop_requested(); }
+
+// runs f(i) for every i in [0, n) on the pool (the last one on this thread), helping out while we wait...
+// ...and rethrows the first exception, but only once every task is finished (they all reference our locals)
+// every task runs under this thread's stop_scope too, and once a stop's been requested, the ones that haven't...
+// ...started are skipped and we throw operation_cancelled - so nobody mistakes a half-done job for a finished one
+template <typename Func>
+void for_each_index(thread_pool &pool, std::size_t n, Func f) {
+    if (!n) { return; }
+
+    std::stop_token token = current_stop_token();
+
+    // always under our token, even an empty one - never under whichever token the thread that runs it happens to have
+    auto run = [&f, &token] (std::size_t i) {
+        if (token.stop_requested()) { return; }
+
+        par::stop_scope scope(token);
+        f(i);
+    };
+
+    std::vector<std::future<void>> futures(n - 1);
+    for (std::size_t i = 0; i != n - 1; ++i) { futures[i] = pool.submit([&run, i] () { run(i); }); }
+
+    std::exception_ptr error;
+
+    try { run(n - 1); } catch (...) { error = std::current_exception(); }
+
+    for (auto &fut : futures) {
+        while (fut.wait_for(std::chrono::seconds(0)) != std::future_status::ready && pool.run_pending_task());
+        try { fut.get(); } catch (...) { if (!error) { error = std::current_exception(); } }
+    }
+
+    if (error) { std::rethrow_exception(error); }
+    if (token.stop_requested()) { throw operation_cancelled(); }
+}
+
+// f(begin, end) over [begin, end) - all in one go, unless we can be cancelled, in which case it's check_every at a...
+// ...time, checking in between (so f has to be happy with any split of the range)
+template <typename Func>
+void for_each_chunk(std::size_t begin, std::size_t end, Func &&f) {
+    const std::stop_token &token = current_stop_token();
+
+    if (!token.stop_possible()) {
+        f(begin, end);
+        return;
+    }
+
+    for (; begin < end && !token.stop_requested(); begin += check_every) { f(begin, std::min(end, begin + check_every)); }
+}
+
+template <typename Func>
+void for_each_block(const blocks &bl, Func f) {
+    for_each_index(shared_pool(), bl.count, [&] (std::size_t b) { for_each_chunk(bl.begin(b), bl.end(b), f); });
+}
+
+// f(i) for i in [begin, end) - with par_unseq, the compiler's told the iterations don't depend on each other
+template <bool Unseq, typename Func>
+void loop(std::size_t begin, std::size_t end, Func &f) {
+    if constexpr (Unseq) {
+        PAR_IVDEP
+        for (std::size_t i = begin; i < end; ++i) { f(i); }
+    } else {
+        for (std::size_t i = begin; i < end; ++i) { f(i); }
+    }
+}
+
+// f(begin, end) reduces one (non-empty) block on its own, and the blocks' results are folded into init in order on this...
+// ...thread - so no identity element is needed, but the op has to be associative and commutative, as for std::reduce
+template <typename _Tp, typename _BinaryOp, typename BlockFunc>
+_Tp reduce_blocks(const blocks &bl, _Tp init, _BinaryOp op, BlockFunc f) {
+    if (!bl.length) { return init; }
+
+    // a block's reduced a chunk at a time, for the same reason as for_each_chunk()
+    std::vector<std::optional<_Tp>> partials(bl.count);
+    for_each_index(shared_pool(), bl.count, [&] (std::size_t b) {
+        for_each_chunk(bl.begin(b), bl.end(b), [&] (std::size_t begin, std::size_t end) {
+            if (partials[b]) { *partials[b] = op(std::move(*partials[b]), f(begin, end)); } else { partials[b].emplace(f(begin, end)); }
+        });
+    });
+
+    for (auto &p : partials) { init = op(std::move(init), std::move(*p)); }
+    return init;
+}
+
+inline void fetch_min(std::atomic<std::size_t> &target, std::size_t value) {
+    std::size_t current = target.load(std::memory_order_relaxed);
+    while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed));
+}
+} // namespace detail
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+template <detail::policy _ExecutionPolicy, typename _ForwardIt, typename _UnaryFunc>
+void for_each(_ExecutionPolicy &&, _ForwardIt __first, _ForwardIt __last, _UnaryFunc __f) {
+    if constexpr (detail::parallel<_ExecutionPolicy, _ForwardIt>) {
+        auto f = [&] (std::size_t i) { __f(__first[i]); };
+        detail::for_each_block(detail::blocks(__last - __first), [&] (std::size_t begin, std::size_t end) {
+            detail::loop<detail::unsequenced<_ExecutionPolicy>>(begin, end, f);
+        });
+    } else {
+        std::for_each(__first, __last, __f);
+    }
+}
+
+template <detail::policy _ExecutionPolicy, typename _ForwardIt1, typename _ForwardIt2, typename _UnaryOp>
+_ForwardIt2 transform(_ExecutionPolicy &&, _ForwardIt1 __first, _ForwardIt1 __last, _ForwardIt2 __d_first, _UnaryOp __op) {
+    if constexpr (detail::parallel<_ExecutionPolicy, _ForwardIt1, _ForwardIt2>) {
+        auto f = [&] (std::size_t i) { __d_first[i] = __op(__first[i]); };
+        detail::for_each_block(detail::blocks(__last - __first), [&] (std::size_t begin, std::size_t end) {
+            detail::loop<detail::unsequenced<_ExecutionPolicy>>(begin, end, f);
+        });
+        return __d_first + (__last - __first);
+    } else {
+        return std::transform(__first, __last, __d_first, __op);
+    }
+}
+
+template <detail::policy _ExecutionPolicy, typename _ForwardIt1, typename _ForwardIt2, typename _ForwardIt3, typename _BinaryOp>
+_ForwardIt3 transform(_ExecutionPolicy &&, _ForwardIt1 __first1, _ForwardIt1 __last1, _ForwardIt2 __first2, _ForwardIt3 __d_first, _BinaryOp __op) {
+    if constexpr (detail::parallel<_ExecutionPolicy, _ForwardIt1, _ForwardIt2, _ForwardIt3>) {
+        auto f = [&] (std::size_t i) { __d_first[i] = __op(__first1[i], __first2[i]); };
+        detail::for_each_block(detail::blocks(__last1 - __first1), [&] (std::size_t begin, std::size_t end) {
+            detail::loop<detail::unsequenced<_ExecutionPolicy>>(begin, end, f);
+        });
+        return __d_first + (__last1 - __first1);
+    } else {
+        return std::transform(__first1, __last1, __first2, __d_first, __op);
+    }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// every block is reduced with the sequential std::transform_reduce, which libstdc++ already unrolls for random-access iterators
+template <detail::policy _ExecutionPolicy, typename _ForwardIt, typename _Tp, typename _BinaryOp, typename _UnaryOp>
+_Tp transform_reduce(_ExecutionPolicy &&, _ForwardIt __first, _ForwardIt __last, _Tp __init, _BinaryOp __reduce, _UnaryOp __transform) {
+    if constexpr (detail::parallel<_ExecutionPolicy, _ForwardIt>) {
+        return detail::reduce_blocks(detail::blocks(__last - __first), std::move(__init), __reduce, [&] (std::size_t begin, std::size_t end) {
+            return std::transform_reduce(__first + begin + 1, __first + end, _Tp(__transform(__first[begin])), __reduce, __transform);
+        });
+    } else {
+        return std::transform_reduce(__first, __last, std::move(__init), __reduce, __transform);
+    }
+}
+
+// inner-product forms
+template <detail::policy _ExecutionPolicy, typename _ForwardIt1, typename _ForwardIt2, typename _Tp, typename _BinaryOp1, typename _BinaryOp2>
+_Tp transform_reduce(_ExecutionPolicy &&, _ForwardIt1 __first1, _ForwardIt1 __last1, _ForwardIt2 __first2, _Tp __init,
+                     _BinaryOp1 __reduce, _BinaryOp2 __transform) {
+    if constexpr (detail::parallel<_ExecutionPolicy, _ForwardIt1, _ForwardIt2>) {
+        return detail::reduce_blocks(detail::blocks(__last1 - __first1), std::move(__init), __reduce, [&] (std::size_t begin, std::size_t end) {
+            return std::transform_reduce(__first1 + begin + 1, __first1 + end, __first2 + begin + 1,
+                                         _Tp(__transform(__first1[begin], __first2[begin])), __reduce, __transform);
+        });
+    } else {
+        return std::transform_reduce(__first1, __last1, __first2, std::move(__init), __reduce, __transform);
+    }
+}
+
+template <detail::policy _ExecutionPolicy, typename _ForwardIt1, typename _ForwardIt2, typename _Tp>
+_Tp transform_reduce(_ExecutionPolicy &&__policy, _ForwardIt1 __first1, _ForwardIt1 __last1, _ForwardIt2 __first2, _Tp __init) {
+    return par::transform_reduce(__policy, __first1, __last1, __first2, std::move(__init), std::plus<>(), std::multiplies<>());
+}
+
+template <detail::policy _ExecutionPolicy, typename _ForwardIt, typename _Tp = typename std::iterator_traits<_ForwardIt>::value_type,
+          typename _BinaryOp = std::plus<>>
+_Tp reduce(_ExecutionPolicy &&__policy, _ForwardIt __first, _ForwardIt __last, _Tp __init = _Tp(), _BinaryOp __op = _BinaryOp()) {
+    return par::transform_reduce(__policy, __first, __last, std::move(__init), __op, std::identity());
+}
+
+template <detail::policy _ExecutionPolicy, typename _ForwardIt, typename _UnaryPred>
+typename std::iterator_traits<_ForwardIt>::difference_type
+count_if(_ExecutionPolicy &&__policy, _ForwardIt __first, _ForwardIt __last, _UnaryPred __pred) {
+    typedef typename std::iterator_traits<_ForwardIt>::difference_type D;
+    return par::transform_reduce(__policy, __first, __last, D(0), std::plus<>(), [&] (const auto &val) { return D(bool(__pred(val))); });
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+namespace detail {
+// `seed` is the value to the left of the block (empty for the very first block of an inclusive scan)
+template <bool Inclusive, typename _RandomIt, typename _OutputIt, typename _Tp, typename _BinaryOp>
+void scan_block(_RandomIt __first, _RandomIt __last, _OutputIt __d_first, const _Tp *__seed, _BinaryOp __op) {
+    if (__first == __last) { return; }
+
+    _Tp running = __seed ? *__seed : _Tp(*__first);
+
+    if (!__seed) { // first block of an inclusive scan - the first element is its own prefix
+        *__d_first = running;
+        ++__first, ++__d_first;
+    }
+
+    for ( ; __first != __last; ++__first, ++__d_first) {
+        if constexpr (Inclusive) {
+            running = __op(std::move(running), *__first);
+            *__d_first = running;
+        } else {
+            _Tp next = __op(running, *__first); // read before writing, so d_first == first still works
+            *__d_first = std::move(running);
+            running = std::move(next);
+        }
+    }
+}
+
+// blocked_partial_sum.cpp - reduce every block but the last, scan the block totals, then every block scans itself...
+// ...from its offset - two reads of the input instead of a barrier per step
+template <bool Inclusive, typename _RandomIt, typename _OutputIt, typename _Tp, typename _BinaryOp>
+_OutputIt scan(_RandomIt __first, _RandomIt __last, _OutputIt __d_first, const _Tp *__init, _BinaryOp __op) {
+    blocks bl(__last - __first);
+    if (!bl.length) { return __d_first; }
+
+    std::vector<std::optional<_Tp>> totals(bl.count - 1);
+
+    if (bl.count > 1) {
+        for_each_index(shared_pool(), bl.count - 1, [&] (std::size_t b) {
+            auto first = __first + bl.begin(b), last = __first + bl.end(b);
+            totals[b].emplace(std::accumulate(std::next(first), last, _Tp(*first), __op));
+        });
+    }
+
+    // exclusive: offsets[b] is everything left of block b, inclusive: everything left of block b + 1
+    std::vector<_Tp> offsets;
+    offsets.reserve(bl.count);
+    if (__init) { offsets.push_back(*__init); }
+
+    for (std::size_t b = 0; b != bl.count - 1; ++b) {
+        offsets.push_back(offsets.empty() ? std::move(*totals[b]) : __op(offsets.back(), std::move(*totals[b])));
+    }
+
+    for_each_index(shared_pool(), bl.count, [&] (std::size_t b) {
+        const _Tp *seed = __init ? &offsets[b] : b ? &offsets[b - 1] : nullptr;
+        scan_block<Inclusive>(__first + bl.begin(b), __first + bl.end(b), __d_first + bl.begin(b), seed, __op);
+    });
+
+    return __d_first + bl.length;
+}
+} // namespace detail
+
+template <detail::policy _ExecutionPolicy, typename _ForwardIt1, typename _ForwardIt2, typename _BinaryOp = std::plus<>>
+_ForwardIt2 inclusive_scan(_ExecutionPolicy &&, _ForwardIt1 __first, _ForwardIt1 __last, _ForwardIt2 __d_first, _BinaryOp __op = _BinaryOp()) {
+    if constexpr (detail::parallel<_ExecutionPolicy, _ForwardIt1, _ForwardIt2>) {
+        typedef typename std::iterator_traits<_ForwardIt1>::value_type T;
+        return detail::scan<true, _ForwardIt1, _ForwardIt2, T>(__first, __last, __d_first, nullptr, __op);
+    } else {
+        return std::inclusive_scan(__first, __last, __d_first, __op);
+    }
+}
+
+template <detail::policy _ExecutionPolicy, typename _ForwardIt1, typename _ForwardIt2, typename _BinaryOp, typename _Tp>
+_ForwardIt2 inclusive_scan(_ExecutionPolicy &&, _ForwardIt1 __first, _ForwardIt1 __last, _ForwardIt2 __d_first, _BinaryOp __op, _Tp __init) {
+    if constexpr (detail::parallel<_ExecutionPolicy, _ForwardIt1, _ForwardIt2>) {
+        return detail::scan<true>(__first, __last, __d_first, &__init, __op);
+    } else {
+        return std::inclusive_scan(__first, __last, __d_first, __op, std::move(__init));
+    }
+}
+
+template <detail::policy _ExecutionPolicy, typename _ForwardIt1, typename _ForwardIt2, typename _Tp, typename _BinaryOp = std::plus<>>
+_ForwardIt2 exclusive_scan(_ExecutionPolicy &&, _ForwardIt1 __first, _ForwardIt1 __last, _ForwardIt2 __d_first, _Tp __init, _BinaryOp __op = _BinaryOp()) {
+    if constexpr (detail::parallel<_ExecutionPolicy, _ForwardIt1, _ForwardIt2>) {
+        return detail::scan<false>(__first, __last, __d_first, &__init, __op);
+    } else {
+        return std::exclusive_scan(__first, __last, __d_first, std::move(__init), __op);
+    }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// pooled_find.cpp - chunks are claimed from the front in order, and everyone keeps track of the lowest match so far...
+// ...a searcher only gives up once it's *past* that match, so we always return the same element std::find_if would
+constexpr std::size_t find_chunk_size = 1 << 15;
+constexpr std::size_t find_check_interval = 1024;
+
+template <detail::policy _ExecutionPolicy, typename _ForwardIt, typename _UnaryPred>
+_ForwardIt find_if(_ExecutionPolicy &&, _ForwardIt __first, _ForwardIt __last, _UnaryPred __pred) {
+    if constexpr (detail::parallel<_ExecutionPolicy, _ForwardIt>) {
+        std::size_t length = __last - __first;
+        std::size_t num_chunks = (length + find_chunk_size - 1) / find_chunk_size;
+
+        thread_pool &pool = shared_pool();
+        std::size_t num_searchers = std::min(pool.thread_count() + 1, num_chunks);
+
+        if (num_searchers < 2) { return std::find_if(__first, __last, __pred); }
+
+        std::atomic<std::size_t> next_chunk(0);
+        std::atomic<std::size_t> found(length); // lowest matching index so far - length means "nothing yet"
+
+        detail::for_each_index(pool, num_searchers, [&] (std::size_t) {
+            try {
+                for (std::size_t begin; (begin = next_chunk.fetch_add(1, std::memory_order_relaxed) * find_chunk_size) < length; ) {
+                    std::size_t end = std::min(begin + find_chunk_size, length);
+
+                    for (std::size_t pos = begin; pos < end; pos += find_check_interval) {
+                        if (found.load(std::memory_order_relaxed) < pos) { return; }
+
+                        std::size_t stop = std::min(pos + find_check_interval, end);
+                        std::size_t hit = std::find_if(__first + pos, __first + stop, __pred) - __first;
+
+                        if (hit != stop) {
+                            detail::fetch_min(found, hit);
+                            return;
+                        }
+                    }
+                }
+            } catch (...) {
+                found.store(0, std::memory_order_relaxed); // nothing can beat 0, so everyone else stops at their next check
+                throw;
+            }
+        });
+
+        return __first + found.load();
+    } else {
+        return std::find_if(__first, __last, __pred);
+    }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// stream compaction - every algorithm here is the same three passes:
+//   1) every block counts (or gathers up) the elements it's keeping
+//   2) an exclusive scan of the per-block counts tells every block where its output starts
+//   3) every block moves its elements straight to their final place
+// N.B. remove_if and unique can't scatter in place (one block's output overlaps another block's input), so it goes through a...
+// ...scratch buffer, which needs the value type to be default-constructible
+namespace detail {
+// output offset of every block, plus the total at the end
+inline std::vector<std::size_t> block_offsets(const std::vector<std::size_t> &counts) {
+    std::vector<std::size_t> offsets(counts.size() + 1);
+    par::inclusive_scan(execution::seq, counts.begin(), counts.end(), offsets.begin() + 1);
+    return offsets;
+}
+
+// once every block has compacted itself, moves block b's counts[b] keepers (starting from kept[b]) down to the front of...
+// ...the range, in order - the first block's keepers have to already be at the front, as they don't move
+template <typename _RandomIt>
+_RandomIt gather_blocks(_RandomIt __first, const blocks &bl, const std::vector<std::size_t> &kept, const std::vector<std::size_t> &counts) {
+    typedef typename std::iterator_traits<_RandomIt>::value_type T;
+
+    auto offsets = block_offsets(counts);
+
+    std::size_t total = offsets.back(), moved = total - counts[0];
+    auto buffer = std::make_unique_for_overwrite<T[]>(moved); // no point zeroing what we're about to overwrite
+
+    for_each_index(shared_pool(), bl.count - 1, [&] (std::size_t b) {
+        auto first = __first + kept[b + 1];
+        std::move(first, first + counts[b + 1], buffer.get() + (offsets[b + 1] - counts[0]));
+    });
+
+    for_each_block(blocks(moved), [&] (std::size_t begin, std::size_t end) {
+        std::move(buffer.get() + begin, buffer.get() + end, __first + counts[0] + begin);
+    });
+
+    return __first + total;
+}
+} // namespace detail
+
+// the predicate's called twice per element (once to count, once to copy) - for the cheap predicates we filter with,...
+// ...that's quicker than writing every answer down and reading it back
+template <detail::policy _ExecutionPolicy, typename _ForwardIt1, typename _ForwardIt2, typename _UnaryPred>
+_ForwardIt2 copy_if(_ExecutionPolicy &&, _ForwardIt1 __first, _ForwardIt1 __last, _ForwardIt2 __d_first, _UnaryPred __pred) {
+    if constexpr (detail::parallel<_ExecutionPolicy, _ForwardIt1, _ForwardIt2>) {
+        detail::blocks bl(__last - __first);
+        if (bl.count == 1) { return std::copy_if(__first, __last, __d_first, __pred); }
+
+        std::vector<std::size_t> counts(bl.count);
+
+        detail::for_each_index(shared_pool(), bl.count, [&] (std::size_t b) {
+            counts[b] = std::count_if(__first + bl.begin(b), __first + bl.end(b), __pred);
+        });
+
+        auto offsets = detail::block_offsets(counts);
+
+        detail::for_each_index(shared_pool(), bl.count, [&] (std::size_t b) {
+            std::copy_if(__first + bl.begin(b), __first + bl.end(b), __d_first + offsets[b], __pred);
+        });
+
+        return __d_first + offsets.back();
+    } else {
+        return std::copy_if(__first, __last, __d_first, __pred);
+    }
+}
+
+template <detail::policy _ExecutionPolicy, typename _ForwardIt, typename _UnaryPred>
+_ForwardIt remove_if(_ExecutionPolicy &&, _ForwardIt __first, _ForwardIt __last, _UnaryPred __pred) {
+    if constexpr (detail::parallel<_ExecutionPolicy, _ForwardIt>) {
+        detail::blocks bl(__last - __first);
+        if (bl.count == 1) { return std::remove_if(__first, __last, __pred); }
+
+        // every block compacts itself in place first, so its keepers are already at the front of it
+        std::vector<std::size_t> kept(bl.count), counts(bl.count);
+
+        detail::for_each_index(shared_pool(), bl.count, [&] (std::size_t b) {
+            kept[b] = bl.begin(b);
+            counts[b] = std::remove_if(__first + bl.begin(b), __first + bl.end(b), __pred) - (__first + bl.begin(b));
+        });
+
+        return detail::gather_blocks(__first, bl, kept, counts);
+    } else {
+        return std::remove_if(__first, __last, __pred);
+    }
+}
+
+// removes all but the first of every run of equal elements, same as std::unique - every block std::unique()s itself, but...
+// ...a block that starts with the same value the one before it ends with has to lose its first element too, so that's...
+// ...checked before anything moves
+template <detail::policy _ExecutionPolicy, typename _ForwardIt, typename _BinaryPred = std::equal_to<>>
+_ForwardIt unique(_ExecutionPolicy &&, _ForwardIt __first, _ForwardIt __last, _BinaryPred __pred = _BinaryPred()) {
+    if constexpr (detail::parallel<_ExecutionPolicy, _ForwardIt>) {
+        detail::blocks bl(__last - __first);
+        if (bl.count == 1) { return std::unique(__first, __last, __pred); }
+
+        std::vector<std::size_t> kept(bl.count), counts(bl.count);
+
+        for (std::size_t b = 1; b != bl.count; ++b) {
+            kept[b] = bl.begin(b) + __pred(*(__first + (bl.begin(b) - 1)), *(__first + bl.begin(b)));
+        }
+
+        detail::for_each_index(shared_pool(), bl.count, [&] (std::size_t b) {
+            counts[b] = std::unique(__first + bl.begin(b), __first + bl.end(b), __pred) - (__first + kept[b]);
+        });
+
+        return detail::gather_blocks(__first, bl, kept, counts);
+    } else {
+        return std::unique(__first, __last, __pred);
+    }
+}
+
+// not stable, same as std::partition - every block partitions itself, which leaves some falses left of the partition...
+// ...point and exactly as many trues right of it, and the k-th of the first lot is swapped with the k-th of the second
+template <detail::policy _ExecutionPolicy, typename _ForwardIt, typename _UnaryPred>
+_ForwardIt partition(_ExecutionPolicy &&, _ForwardIt __first, _ForwardIt __last, _UnaryPred __pred) {
+    if constexpr (detail::parallel<_ExecutionPolicy, _ForwardIt>) {
+        detail::blocks bl(__last - __first);
+        if (bl.count == 1) { return std::partition(__first, __last, __pred); }
+
+        std::vector<std::size_t> counts(bl.count);
+
+        detail::for_each_index(shared_pool(), bl.count, [&] (std::size_t b) {
+            counts[b] = std::partition(__first + bl.begin(b), __first + bl.end(b), __pred) - (__first + bl.begin(b));
+        });
+
+        std::size_t total = detail::block_offsets(counts).back();
+
+        // the misplaced elements, as runs - every block's falses that are left of total, and its trues that are right of it
+        struct run { std::size_t begin, end; };
+        std::vector<run> falses, trues;
+
+        for (std::size_t b = 0; b != bl.count; ++b) {
+            std::size_t middle = bl.begin(b) + counts[b];
+            if (middle < std::min(bl.end(b), total)) { falses.push_back({ middle, std::min(bl.end(b), total) }); }
+            if (middle > std::max(bl.begin(b), total)) { trues.push_back({ std::max(bl.begin(b), total), middle }); }
+        }
+
+        if (falses.empty()) { return __first + total; }
+
+        // misplaced[k] is how many misplaced elements come before the k-th run
+        auto starts = [] (const std::vector<run> &runs) {
+            std::vector<std::size_t> misplaced(runs.size() + 1);
+            for (std::size_t r = 0; r != runs.size(); ++r) { misplaced[r + 1] = misplaced[r] + runs[r].end - runs[r].begin; }
+            return misplaced;
+        };
+
+        auto false_starts = starts(falses), true_starts = starts(trues);
+
+        // every thread takes an equal share of the swaps, finding where its share starts with a binary search over the runs
+        detail::blocks swaps(false_starts.back());
+
+        detail::for_each_block(swaps, [&] (std::size_t begin, std::size_t end) {
+            std::size_t f = std::upper_bound(false_starts.begin(), false_starts.end(), begin) - false_starts.begin() - 1;
+            std::size_t t = std::upper_bound(true_starts.begin(), true_starts.end(), begin) - true_starts.begin() - 1;
+
+            std::size_t i = falses[f].begin + (begin - false_starts[f]);
+            std::size_t j = trues[t].begin + (begin - true_starts[t]);
+
+            for (std::size_t k = begin; k != end; ++k) {
+                if (i == falses[f].end) { i = falses[++f].begin; }
+                if (j == trues[t].end) { j = trues[++t].begin; }
+                std::iter_swap(__first + i++, __first + j++);
+            }
+        });
+
+        return __first + total;
+    } else {
+        return std::partition(__first, __last, __pred);
+    }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+namespace detail {
+// every thread's bins start on a cache line of their own, so nobody's counting on a line that someone else is too
+template <typename T>
+struct cache_aligned_allocator {
+    typedef T value_type;
+
+    cache_aligned_allocator() = default;
+    template <typename U> cache_aligned_allocator(const cache_aligned_allocator<U>&) { }
+
+    T* allocate(std::size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(cache_line_size))); }
+    void deallocate(T *p, std::size_t) { ::operator delete(p, std::align_val_t(cache_line_size)); }
+
+    template <typename U> bool operator==(const cache_aligned_allocator<U>&) const { return true; }
+};
+} // namespace detail
+
+// counts[k] is how many elements __bin_of puts in bin k, which has to be less than __num_bins
+// every thread counts its own block into its own (padded, cache-aligned) row of bins - there's no sharing, so no atomics...
+// ...and once they're all done, every thread adds up a slice of the bins down all the rows
+template <detail::policy _ExecutionPolicy, typename _ForwardIt, typename _BinOf = std::identity>
+std::vector<std::size_t> histogram(_ExecutionPolicy &&, _ForwardIt __first, _ForwardIt __last, std::size_t __num_bins, _BinOf __bin_of = _BinOf()) {
+    std::vector<std::size_t> counts(__num_bins);
+
+    if constexpr (detail::parallel<_ExecutionPolicy, _ForwardIt>) {
+        detail::blocks bl(__last - __first);
+
+        if (bl.count > 1) {
+            constexpr std::size_t per_line = detail::cache_line_size / sizeof(std::size_t);
+            std::size_t stride = (__num_bins + per_line - 1) / per_line * per_line;
+
+            std::vector<std::size_t, detail::cache_aligned_allocator<std::size_t>> rows(bl.count * stride);
+
+            detail::for_each_index(shared_pool(), bl.count, [&] (std::size_t b) {
+                std::size_t *row = rows.data() + b * stride;
+                for (auto first = __first + bl.begin(b), last = __first + bl.end(b); first != last; ++first) { ++row[static_cast<std::size_t>(__bin_of(*first))]; }
+            });
+
+            // only worth splitting up if there are lots of bins
+            detail::for_each_block(detail::blocks(__num_bins), [&] (std::size_t begin, std::size_t end) {
+                for (std::size_t b = 0; b != bl.count; ++b) {
+                    const std::size_t *row = rows.data() + b * stride;
+                    for (std::size_t k = begin; k != end; ++k) { counts[k] += row[k]; }
+                }
+            });
+
+            return counts;
+        }
+    }
+
+    for ( ; __first != __last; ++__first) { ++counts[static_cast<std::size_t>(__bin_of(*__first))]; }
+    return counts;
+}
+
+// group-by-count, for when the keys are too spread out for a bin each - every thread counts its block into a hash map of...
+// ...its own, and the maps are merged in pairs, with every pair in a round merged in parallel, until there's only one left
+template <detail::policy _ExecutionPolicy, typename _ForwardIt, typename _KeyOf = std::identity,
+          typename _Key = std::remove_cvref_t<std::invoke_result_t<_KeyOf&, typename std::iterator_traits<_ForwardIt>::reference>>,
+          typename _Hash = std::hash<_Key>>
+std::unordered_map<_Key, std::size_t, _Hash> count_by_key(_ExecutionPolicy &&, _ForwardIt __first, _ForwardIt __last, _KeyOf __key_of = _KeyOf()) {
+    typedef std::unordered_map<_Key, std::size_t, _Hash> map_type;
+
+    if constexpr (detail::parallel<_ExecutionPolicy, _ForwardIt>) {
+        detail::blocks bl(__last - __first);
+
+        if (bl.count > 1) {
+            std::vector<map_type> maps(bl.count);
+
+            detail::for_each_index(shared_pool(), bl.count, [&] (std::size_t b) {
+                for (std::size_t i = bl.begin(b); i != bl.end(b); ++i) { ++maps[b][__key_of(__first[i])]; }
+            });
+
+            // round r merges map b + 2^r into map b, for every b that's a multiple of 2^(r + 1)
+            for (std::size_t step = 1; step < bl.count; step *= 2) {
+                detail::for_each_index(shared_pool(), (bl.count - step + 2 * step - 1) / (2 * step), [&] (std::size_t pair) {
+                    map_type &into = maps[pair * 2 * step], &from = maps[pair * 2 * step + step];
+                    if (into.size() < from.size()) { into.swap(from); } // walk the smaller of the two
+                    into.reserve(into.size() + from.size());
+
+                    for (auto &[key, count] : from) { into[key] += count; }
+                    map_type().swap(from);
+                });
+            }
+
+            return std::move(maps[0]);
+        }
+    }
+
+    map_type counts;
+    for ( ; __first != __last; ++__first) { ++counts[__key_of(*__first)]; }
+    return counts;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// dense, row-major matrices - the Chapter 8 matrix discussion, with code
+namespace detail {
+// the register tile - mr rows of C by a cache line's worth of columns, kept in registers for the whole of a kc-long dot...
+// ...product (4 x 8 doubles is 16 SSE registers, or 8 AVX ones)
+template <typename T> inline constexpr std::size_t gemm_mr = 4;
+template <typename T> inline constexpr std::size_t gemm_nr = cache_line_size / sizeof(T);
+
+// the cache tiles - a kc x nr sliver of B stays in L1, and an mc x kc block of A stays in L2, while we sweep over them
+template <typename T> inline constexpr std::size_t gemm_kc = 256;
+template <typename T> inline constexpr std::size_t gemm_mc = 128 * 1024 / (gemm_kc<T> * sizeof(T)) / gemm_mr<T> * gemm_mr<T>;
+
+// copies rows [row, row + mc) x columns [col, col + kc) of a into mr-row slivers, so the kernel reads a strictly in order...
+// ...(rows past the edge of the matrix are zero, so the kernel never has to check)
+template <typename T>
+void pack_a(const T *a, std::size_t lda, std::size_t rows, std::size_t cols, T *out) {
+    constexpr std::size_t mr = gemm_mr<T>;
+
+    for (std::size_t i = 0; i < rows; i += mr) {
+        for (std::size_t p = 0; p != cols; ++p) {
+            for (std::size_t r = 0; r != mr; ++r) { *out++ = i + r < rows ? a[(i + r) * lda + p] : T(); }
+        }
+    }
+}
+
+// the same for b, in nr-column slivers - every sliver is depth rows deep, so a run of rows can be packed on its own
+template <typename T>
+void pack_b(const T *b, std::size_t ldb, std::size_t rows, std::size_t cols, std::size_t depth, T *out) {
+    constexpr std::size_t nr = gemm_nr<T>;
+
+    for (std::size_t j = 0; j < cols; j += nr) {
+        T *sliver = out + j * depth;
+
+        for (std::size_t p = 0; p != rows; ++p) {
+            for (std::size_t c = 0; c != nr; ++c) { sliver[p * nr + c] = j + c < cols ? b[p * ldb + j + c] : T(); }
+        }
+    }
+}
+
+// c[mr x nr] (+)= a-sliver * b-sliver - every loop but the outer one has a fixed trip count, so once they're unrolled...
+// ...acc lives in vector registers (GCC won't unroll them at -O2 without being asked, and it's 3-4x slower if it doesn't)
+template <typename T>
+void gemm_kernel(std::size_t kc, const T *a, const T *b, T *c, std::size_t ldc, std::size_t rows, std::size_t cols, bool accumulate) {
+    constexpr std::size_t mr = gemm_mr<T>, nr = gemm_nr<T>;
+
+    T acc[mr][nr] = {};
+
+    for (std::size_t p = 0; p != kc; ++p, a += mr, b += nr) {
+        PAR_UNROLL
+        for (std::size_t i = 0; i != mr; ++i) {
+            PAR_UNROLL
+            for (std::size_t j = 0; j != nr; ++j) { acc[i][j] += a[i] * b[j]; }
+        }
+    }
+
+    for (std::size_t i = 0; i != rows; ++i) {
+        for (std::size_t j = 0; j != cols; ++j) { c[i * ldc + j] = accumulate ? c[i * ldc + j] + acc[i][j] : acc[i][j]; }
+    }
+}
+} // namespace detail
+
+// c (m x n) = a (m x k) * b (k x n), all row-major
+// for every kc-deep slice of the k dimension, b's slice is packed once (in parallel), then every task takes an mc-row block...
+// ...of c, packs its bit of a, and sweeps the register tile across it - c's blocks never overlap, so there's no sharing
+template <detail::policy _ExecutionPolicy, typename T>
+void gemm(_ExecutionPolicy &&, std::size_t m, std::size_t n, std::size_t k, const T *a, const T *b, T *c) {
+    constexpr std::size_t mr = detail::gemm_mr<T>, nr = detail::gemm_nr<T>;
+    constexpr std::size_t kc = detail::gemm_kc<T>, mc = detail::gemm_mc<T>;
+    constexpr bool parallel = detail::parallel<_ExecutionPolicy>;
+
+    if (!m || !n) { return; }
+    if (!k) { std::fill(c, c + m * n, T()); return; }
+
+    std::size_t n_padded = (n + nr - 1) / nr * nr;
+    std::vector<T> packed_b(kc * n_padded);
+
+    std::size_t row_blocks = (m + mc - 1) / mc;
+    std::size_t col_slivers = n_padded / nr;
+
+    auto for_each = [&] (std::size_t count, auto f) {
+        if constexpr (parallel) { detail::for_each_index(shared_pool(), count, f); }
+        else { for (std::size_t i = 0; i != count; ++i) { f(i); } }
+    };
+
+    for (std::size_t pc = 0; pc < k; pc += kc) {
+        std::size_t depth = std::min(kc, k - pc);
+
+        // every task packs a run of b's rows
+        std::size_t tasks = parallel ? detail::blocks(depth * n).count : 1;
+        std::size_t rows_per_task = (depth + tasks - 1) / tasks;
+
+        for_each((depth + rows_per_task - 1) / rows_per_task, [&] (std::size_t t) {
+            std::size_t first = t * rows_per_task;
+            detail::pack_b(b + (pc + first) * n, n, std::min(rows_per_task, depth - first), n, depth, packed_b.data() + first * nr);
+        });
+
+        for_each(row_blocks, [&] (std::size_t ib) {
+            std::size_t ic = ib * mc, rows = std::min(mc, m - ic);
+
+            std::vector<T> packed_a((rows + mr - 1) / mr * mr * depth);
+            detail::pack_a(a + ic * k + pc, k, rows, depth, packed_a.data());
+
+            for (std::size_t jr = 0; jr != col_slivers; ++jr) {
+                const T *b_sliver = packed_b.data() + jr * nr * depth;
+                std::size_t cols = std::min(nr, n - jr * nr);
+
+                for (std::size_t ir = 0; ir < rows; ir += mr) {
+                    detail::gemm_kernel(depth, packed_a.data() + ir * depth, b_sliver, c + (ic + ir) * n + jr * nr, n,
+                                        std::min(mr, rows - ir), cols, pc != 0);
+                }
+            }
+        });
+    }
+}
+
+// out (n x m) = transpose of in (m x n) - in square tiles, so both the reads and the writes stay within a few cache lines...
+// ...rather than one of them striding across the whole matrix, and every task takes a band of tile rows
+template <detail::policy _ExecutionPolicy, typename T>
+void transpose(_ExecutionPolicy &&, std::size_t m, std::size_t n, const T *in, T *out) {
+    constexpr std::size_t tile = detail::cache_line_size / sizeof(T) < 8 ? 8 : detail::cache_line_size / sizeof(T);
+    if (!m || !n) { return; }
+
+    auto band = [&] (std::size_t begin, std::size_t end) {
+        for (std::size_t i0 = begin; i0 < end; i0 += tile) {
+            for (std::size_t j0 = 0; j0 < n; j0 += tile) {
+                std::size_t i1 = std::min(i0 + tile, end), j1 = std::min(j0 + tile, n);
+
+                for (std::size_t i = i0; i != i1; ++i) {
+                    for (std::size_t j = j0; j != j1; ++j) { out[j * m + i] = in[i * n + j]; }
+                }
+            }
+        }
+    };
+
+    if constexpr (detail::parallel<_ExecutionPolicy>) {
+        std::size_t tile_rows = (m + tile - 1) / tile;
+        detail::blocks bl(m * n);
+        std::size_t per_task = (tile_rows + bl.count - 1) / bl.count * tile;
+
+        detail::for_each_index(shared_pool(), (m + per_task - 1) / per_task, [&] (std::size_t t) {
+            band(t * per_task, std::min(m, (t + 1) * per_task));
+        });
+    } else {
+        band(0, m);
+    }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+namespace detail {
+// below this, std::sort on one thread wins
+constexpr std::size_t min_parallel_sort = 1 << 15;
+
+// buckets per thread - more buckets balance better, but make every element's binary search a little longer
+constexpr std::size_t buckets_per_thread = 8;
+
+// sample this many elements per splitter, so the buckets come out roughly the same size
+constexpr std::size_t oversampling = 16;
+
+// n elements picked at random (with replacement) from a non-empty range, sorted - a fixed seed, so the same input always...
+// ...gives the same sample
+template <typename _RandomIt, typename _Compare>
+std::vector<typename std::iterator_traits<_RandomIt>::value_type>
+sorted_sample(_RandomIt __first, _RandomIt __last, std::size_t n, _Compare &__comp) {
+    std::size_t length = std::distance(__first, __last);
+
+    std::vector<typename std::iterator_traits<_RandomIt>::value_type> sample;
+    sample.reserve(n);
+
+    std::minstd_rand e(length);
+    std::uniform_int_distribution<std::size_t> u(0, length - 1);
+    for (std::size_t i = 0; i != n; ++i) { sample.push_back(*(__first + u(e))); }
+
+    std::sort(sample.begin(), sample.end(), __comp);
+    return sample;
+}
+
+// samplesort - pick splitters from a sorted sample, then every thread...
+//   1) counts how many of its block's elements fall into each bucket
+//   2) (after a prefix sum of the counts) moves its elements into their buckets in a scratch buffer
+//   3) sorts whole buckets and moves them back
+// every element that's equal to a splitter goes into its own "equality" bucket, which is already sorted - so lots of...
+// ...duplicates can't pile up in one bucket and leave a single thread to do all the work
+// N.B. needs the value type to be default-constructible (for the scratch buffer)
+// cancelling only stops 1) early - once the elements start moving out, they all have to come back, so 2) always runs...
+// ...to the end, and 3) still moves every bucket back, it just stops sorting them - whatever happens, the range is left...
+// ...holding the same elements it started with
+template <typename _RandomIt, typename _Compare = std::less<>>
+void sample_sort(_RandomIt __first, _RandomIt __last, _Compare __comp) {
+    typedef typename std::iterator_traits<_RandomIt>::value_type T;
+
+    std::size_t length = std::distance(__first, __last);
+
+    thread_pool &pool = shared_pool();
+    std::size_t num_threads = pool.thread_count() + 1; // +1 for this thread
+
+    if (length < min_parallel_sort) {
+        std::sort(__first, __last, __comp);
+        return;
+    }
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+    // splitters, picked from a sample of the input
+    // one less than a power of two of them, so they make a complete binary tree for bucket_of()
+    std::size_t num_splitters = std::bit_ceil(num_threads * buckets_per_thread) - 1;
+
+    auto sample = sorted_sample(__first, __last, (num_splitters + 1) * oversampling, __comp);
+
+    std::vector<T> splitters;
+    splitters.reserve(num_splitters);
+    for (std::size_t i = 1; i <= num_splitters; ++i) { splitters.push_back(sample[i * oversampling]); }
+
+    // the same splitters laid out breadth-first (tree[1] is the root, tree[j]'s children are tree[2j] and tree[2j + 1])...
+    // ...so finding a bucket is log2 steps of "go left or right" with no branch to mispredict
+    std::vector<T> tree(num_splitters + 1);
+
+    for (std::size_t level = num_splitters + 1, step = 1; level > 1; level /= 2, step *= 2) {
+        for (std::size_t j = level / 2, i = step - 1; j != level; ++j, i += 2 * step) { tree[j] = splitters[i]; }
+    }
+
+    // splitter j has an equality bucket 2j + 1, with the elements strictly between splitters j - 1 and j in bucket 2j
+    std::size_t num_buckets = 2 * num_splitters + 1;
+
+    auto bucket_of = [&] (const T &val) {
+        std::size_t j = 1;
+        while (j <= num_splitters) { j = 2 * j + !__comp(val, tree[j]); }
+        j -= num_splitters + 1; // how many splitters are <= val
+
+        return j && !__comp(splitters[j - 1], val) ? 2 * j - 1 : 2 * j;
+    };
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+    std::size_t block_size = length / num_threads;
+
+    auto block_begin = [&] (std::size_t b) { return __first + b * block_size; };
+    auto block_end   = [&] (std::size_t b) { return b == num_threads - 1 ? __last : __first + (b + 1) * block_size; };
+
+    // counts[b * num_buckets + k] - each thread only writes its own row
+    std::vector<std::size_t> counts(num_threads * num_buckets);
+
+    // remember every element's bucket, so the scatter doesn't have to work it out again
+    std::vector<std::uint16_t> oracle(length);
+
+    for_each_index(pool, num_threads, [&] (std::size_t b) {
+        std::size_t *row = &counts[b * num_buckets];
+
+        for_each_chunk(block_begin(b) - __first, block_end(b) - __first, [&] (std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i != end; ++i) {
+                oracle[i] = static_cast<std::uint16_t>(bucket_of(*(__first + i)));
+                ++row[oracle[i]];
+            }
+        });
+    });
+
+    // bucket-major prefix sum - block b's elements for bucket k go after every earlier block's elements for bucket k
+    std::vector<std::size_t> bucket_start(num_buckets + 1);
+    std::size_t offset = 0;
+
+    for (std::size_t k = 0; k != num_buckets; ++k) {
+        bucket_start[k] = offset;
+
+        for (std::size_t b = 0; b != num_threads; ++b) {
+            std::size_t count = counts[b * num_buckets + k];
+            counts[b * num_buckets + k] = offset;
+            offset += count;
+        }
+    }
+
+    bucket_start[num_buckets] = length;
+
+    std::stop_token token = current_stop_token();
+    par::stop_scope uncancellable { std::stop_token() };
+
+    std::vector<T> buffer(length);
+
+    for_each_index(pool, num_threads, [&] (std::size_t b) {
+        std::size_t *row = &counts[b * num_buckets];
+
+        for_each_chunk(block_begin(b) - __first, block_end(b) - __first, [&] (std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i != end; ++i) { buffer[row[oracle[i]]++] = std::move(*(__first + i)); }
+        });
+    });
+
+    // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+    // one task per bucket - there are a few per thread, so an unlucky big one doesn't hold everybody up
+    for_each_index(pool, num_buckets, [&] (std::size_t k) {
+        auto first = buffer.begin() + bucket_start[k], last = buffer.begin() + bucket_start[k + 1];
+
+        if (k % 2 == 0 && !token.stop_requested()) { std::sort(first, last, __comp); } // odd buckets are all equal to their splitter
+        std::move(first, last, __first + bucket_start[k]);
+    });
+
+    if (token.stop_requested()) { throw operation_cancelled(); }
+}
+} // namespace detail
+
+template <detail::policy _ExecutionPolicy, typename _RandomIt, typename _Compare = std::less<>>
+void sort(_ExecutionPolicy &&, _RandomIt __first, _RandomIt __last, _Compare __comp = _Compare()) {
+    if constexpr (detail::parallel<_ExecutionPolicy, _RandomIt>) {
+        detail::sample_sort(__first, __last, __comp);
+    } else {
+        std::sort(__first, __last, __comp);
+    }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+namespace detail {
+// Floyd-Rivest - take two pivots from a sorted sample, either side of where the nth element ought to be in it, and the...
+// ...nth element almost always ends up between them. Two parallel partitions split the range into < lo | lo..hi | > hi...
+// ...and with a sample of n^(2/3), the middle is only ~4 / n^(1/3) of what's left (1.6% of 16M), so a round or two...
+// ...is usually enough to get it small enough for std::nth_element
+template <typename _RandomIt, typename _Compare>
+void sample_select(_RandomIt __first, _RandomIt __nth, _RandomIt __last, _Compare __comp) {
+    typedef typename std::iterator_traits<_RandomIt>::value_type T;
+
+    while (static_cast<std::size_t>(__last - __first) >= min_parallel_sort) {
+        std::size_t length = __last - __first;
+
+        // gap is about two standard deviations of the nth element's position in the sample either way
+        std::size_t sample_size = std::size_t(1) << (std::bit_width(length) * 2 / 3);
+        std::size_t gap = std::size_t(2) << (std::bit_width(sample_size) / 2);
+
+        auto sample = sorted_sample(__first, __last, sample_size, __comp);
+        std::size_t at = (__nth - __first) * sample_size / length;
+
+        // a pivot off the end of the sample is just the end of the range (nothing to split off on that side)
+        auto middle_first = __first, middle_last = __last;
+
+        if (at >= gap) {
+            const T &lo = sample[at - gap];
+            middle_first = par::partition(execution::par, __first, __last, [&] (const T &x) { return __comp(x, lo); });
+        }
+
+        if (__nth < middle_first) {
+            __last = middle_first;
+            continue;
+        }
+
+        if (at + gap < sample_size) {
+            const T &hi = sample[at + gap];
+            middle_last = par::partition(execution::par, middle_first, __last, [&] (const T &x) { return !__comp(hi, x); });
+        }
+
+        if (__nth < middle_last) {
+            // lo and hi are equal, so everything in between is too - the nth element's already in place
+            if (at >= gap && at + gap < sample_size && !__comp(sample[at - gap], sample[at + gap])) { return; }
+
+            __first = middle_first, __last = middle_last;
+        } else {
+            __first = middle_last;
+        }
+
+        // a bad sample (or lots of equal elements) - not worth another round
+        if (static_cast<std::size_t>(__last - __first) > length / 2) { break; }
+    }
+
+    std::nth_element(__first, __nth, __last, __comp);
+}
+} // namespace detail
+
+template <detail::policy _ExecutionPolicy, typename _RandomIt, typename _Compare = std::less<>>
+void nth_element(_ExecutionPolicy &&, _RandomIt __first, _RandomIt __nth, _RandomIt __last, _Compare __comp = _Compare()) {
+    if (__nth == __last) { return; }
+
+    if constexpr (detail::parallel<_ExecutionPolicy, _RandomIt>) {
+        detail::sample_select(__first, __nth, __last, __comp);
+    } else {
+        std::nth_element(__first, __nth, __last, __comp);
+    }
+}
+
+// the k elements that would come first if [first, last) were sorted by comp, in that order - so the k largest by default
+// every block keeps a heap of its best k so far (the worst of them on top, to be kicked out by anything better), and the...
+// ...heaps are merged at the end - the input's only ever read, and it's O(n log k) work instead of a full sort's O(n log n)
+template <detail::policy _ExecutionPolicy, typename _ForwardIt, typename _Compare = std::greater<>>
+std::vector<typename std::iterator_traits<_ForwardIt>::value_type>
+partial_sort_top_k(_ExecutionPolicy &&, _ForwardIt __first, _ForwardIt __last, std::size_t __k, _Compare __comp = _Compare()) {
+    typedef typename std::iterator_traits<_ForwardIt>::value_type T;
+
+    // fill the heap up to k first, so the loop that does nearly all the work is just one comparison per element
+    auto add_to = [&] (std::vector<T> heap, auto first, auto last) {
+        for (; heap.size() < __k && first != last; ++first) {
+            heap.push_back(*first);
+            std::push_heap(heap.begin(), heap.end(), __comp);
+        }
+
+        if (heap.empty()) { return heap; }
+
+        // the top's always at the same address once the heap's full - going through heap.front() every time was 2x slower
+        for (const T *worst = &heap.front(); first != last; ++first) {
+            if (__comp(*first, *worst)) {
+                std::pop_heap(heap.begin(), heap.end(), __comp);
+                heap.back() = *first;
+                std::push_heap(heap.begin(), heap.end(), __comp);
+            }
+        }
+
+        return heap;
+    };
+
+    std::vector<T> heap;
+    if (!__k) { return heap; }
+
+    if constexpr (detail::parallel<_ExecutionPolicy, _ForwardIt>) {
+        detail::blocks bl(std::distance(__first, __last));
+
+        std::vector<std::vector<T>> heaps(bl.count);
+
+        // not reduce_blocks() - if we can be cancelled, that'd make a heap per chunk and merge them, whereas a chunk can...
+        // ...just carry on with the heap the chunk before it left behind
+        detail::for_each_index(shared_pool(), bl.count, [&] (std::size_t b) {
+            heaps[b].reserve(std::min(__k, bl.end(b) - bl.begin(b)));
+
+            detail::for_each_chunk(bl.begin(b), bl.end(b), [&] (std::size_t begin, std::size_t end) {
+                heaps[b] = add_to(std::move(heaps[b]), __first + begin, __first + end);
+            });
+        });
+
+        for (auto &h : heaps) { heap = add_to(std::move(heap), h.begin(), h.end()); }
+    } else {
+        heap = add_to(std::move(heap), __first, __last);
+    }
+
+    std::sort_heap(heap.begin(), heap.end(), __comp);
+    return heap;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// combining sorted ranges - the merge of the two inputs is cut into one segment per block by co-ranking (a binary search...
+// ...for how much of each input comes before the cut), so every block gets an equal share of the output, however the...
+// ...inputs interleave. merge knows where every segment's output goes; the set operations don't until they've run
+namespace detail {
+// how many of the first k elements of merge(a, b) come from a (the rest come from b) - ties go to a, as with std::merge
+template <typename _RandomIt1, typename _RandomIt2, typename _Compare>
+std::size_t co_rank(std::size_t k, _RandomIt1 a, std::size_t m, _RandomIt2 b, std::size_t n, _Compare &comp) {
+    std::size_t lo = k > n ? k - n : 0, hi = std::min(k, m);
+
+    while (lo < hi) {
+        std::size_t i = lo + (hi - lo) / 2, j = k - i;
+
+        // b[j - 1] isn't less than a[i], so a[i] should have been output first - take more from a
+        if (j && !comp(b[j - 1], a[i])) {
+            lo = i + 1;
+        } else {
+            hi = i;
+        }
+    }
+
+    return lo;
+}
+
+// segment s is [a_cut[s], a_cut[s + 1]) of a and [b_cut[s], b_cut[s + 1]) of b - with WholeValues, every cut is moved back...
+// ...to the start of the value it lands on, so all the elements equal to each other end up in the same segment (the...
+// ...set operations pair them up, so they can't be split)
+struct merge_cuts { std::vector<std::size_t> a_cut, b_cut; };
+
+template <bool WholeValues, typename _RandomIt1, typename _RandomIt2, typename _Compare>
+merge_cuts cut_merge(const blocks &bl, _RandomIt1 a, std::size_t m, _RandomIt2 b, std::size_t n, _Compare &comp) {
+    merge_cuts cuts { std::vector<std::size_t>(bl.count + 1), std::vector<std::size_t>(bl.count + 1) };
+    cuts.a_cut[bl.count] = m, cuts.b_cut[bl.count] = n;
+
+    for_each_index(shared_pool(), bl.count - 1, [&] (std::size_t s) {
+        std::size_t k = bl.end(s), i = co_rank(k, a, m, b, n, comp), j = k - i;
+
+        if constexpr (WholeValues) {
+            // the (k + 1)-th element of the merge - a[i] unless b[j] is smaller
+            const auto &value = i != m && (j == n || !comp(b[j], a[i])) ? a[i] : b[j];
+            i = std::lower_bound(a, a + i, value, comp) - a;
+            j = std::lower_bound(b, b + j, value, comp) - b;
+        }
+
+        cuts.a_cut[s + 1] = i, cuts.b_cut[s + 1] = j;
+    });
+
+    return cuts;
+}
+
+// set_op(first1, last1, first2, last2, out) is std::set_union or the like - the first segment writes straight to the...
+// ...output, and the rest write to scratch space of their own (no segment's output is longer than its input), which is...
+// ...moved into place once the segments before it have said how much they wrote. Running the set operation twice...
+// ...instead, once just to count, was twice as slow - it's mostly branch mispredictions, where the extra copy isn't
+template <typename _RandomIt1, typename _RandomIt2, typename _RandomIt3, typename _Compare, typename SetOp>
+_RandomIt3 set_operation(_RandomIt1 __first1, _RandomIt1 __last1, _RandomIt2 __first2, _RandomIt2 __last2,
+                         _RandomIt3 __d_first, _Compare &__comp, SetOp set_op) {
+    typedef typename std::iterator_traits<_RandomIt1>::value_type T;
+
+    std::size_t m = __last1 - __first1, n = __last2 - __first2;
+
+    blocks bl(m + n);
+    if (bl.count == 1) { return set_op(__first1, __last1, __first2, __last2, __d_first); }
+
+    auto [a_cut, b_cut] = cut_merge<true>(bl, __first1, m, __first2, n, __comp);
+
+    std::vector<std::size_t> counts(bl.count);
+    std::vector<std::vector<T>> scratch(bl.count);
+
+    for_each_index(shared_pool(), bl.count, [&] (std::size_t s) {
+        auto first1 = __first1 + a_cut[s], last1 = __first1 + a_cut[s + 1];
+        auto first2 = __first2 + b_cut[s], last2 = __first2 + b_cut[s + 1];
+
+        if (s == 0) {
+            counts[s] = set_op(first1, last1, first2, last2, __d_first) - __d_first;
+        } else {
+            scratch[s].reserve((last1 - first1) + (last2 - first2));
+            set_op(first1, last1, first2, last2, std::back_inserter(scratch[s]));
+            counts[s] = scratch[s].size();
+        }
+    });
+
+    auto offsets = block_offsets(counts);
+
+    for_each_index(shared_pool(), bl.count - 1, [&] (std::size_t s) {
+        std::move(scratch[s + 1].begin(), scratch[s + 1].end(), __d_first + offsets[s + 1]);
+    });
+
+    return __d_first + offsets.back();
+}
+} // namespace detail
+
+template <detail::policy _ExecutionPolicy, typename _ForwardIt1, typename _ForwardIt2, typename _ForwardIt3, typename _Compare = std::less<>>
+_ForwardIt3 merge(_ExecutionPolicy &&, _ForwardIt1 __first1, _ForwardIt1 __last1, _ForwardIt2 __first2, _ForwardIt2 __last2,
+                  _ForwardIt3 __d_first, _Compare __comp = _Compare()) {
+    if constexpr (detail::parallel<_ExecutionPolicy, _ForwardIt1, _ForwardIt2, _ForwardIt3>) {
+        std::size_t m = __last1 - __first1, n = __last2 - __first2;
+
+        detail::blocks bl(m + n);
+        auto [a_cut, b_cut] = detail::cut_merge<false>(bl, __first1, m, __first2, n, __comp);
+
+        detail::for_each_index(shared_pool(), bl.count, [&] (std::size_t s) {
+            std::merge(__first1 + a_cut[s], __first1 + a_cut[s + 1], __first2 + b_cut[s], __first2 + b_cut[s + 1],
+                       __d_first + bl.begin(s), __comp);
+        });
+
+        return __d_first + (m + n);
+    } else {
+        return std::merge(__first1, __last1, __first2, __last2, __d_first, __comp);
+    }
+}
+
+template <detail::policy _ExecutionPolicy, typename _ForwardIt1, typename _ForwardIt2, typename _ForwardIt3, typename _Compare = std::less<>>
+_ForwardIt3 set_union(_ExecutionPolicy &&, _ForwardIt1 __first1, _ForwardIt1 __last1, _ForwardIt2 __first2, _ForwardIt2 __last2,
+                      _ForwardIt3 __d_first, _Compare __comp = _Compare()) {
+    if constexpr (detail::parallel<_ExecutionPolicy, _ForwardIt1, _ForwardIt2, _ForwardIt3>) {
+        return detail::set_operation(__first1, __last1, __first2, __last2, __d_first, __comp, [&] (auto... args) {
+            return std::set_union(args..., __comp);
+        });
+    } else {
+        return std::set_union(__first1, __last1, __first2, __last2, __d_first, __comp);
+    }
+}
+
+template <detail::policy _ExecutionPolicy, typename _ForwardIt1, typename _ForwardIt2, typename _ForwardIt3, typename _Compare = std::less<>>
+_ForwardIt3 set_intersection(_ExecutionPolicy &&, _ForwardIt1 __first1, _ForwardIt1 __last1, _ForwardIt2 __first2, _ForwardIt2 __last2,
+                             _ForwardIt3 __d_first, _Compare __comp = _Compare()) {
+    if constexpr (detail::parallel<_ExecutionPolicy, _ForwardIt1, _ForwardIt2, _ForwardIt3>) {
+        return detail::set_operation(__first1, __last1, __first2, __last2, __d_first, __comp, [&] (auto... args) {
+            return std::set_intersection(args..., __comp);
+        });
+    } else {
+        return std::set_intersection(__first1, __last1, __first2, __last2, __d_first, __comp);
+    }
+}
+} // namespace par (parallel)
+
+#endif // PAR_H
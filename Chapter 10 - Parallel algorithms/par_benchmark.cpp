@@ -0,0 +1,249 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <execution>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include "bench.h"
+#include "par.h"
+
+// every benchmark below is run four times - std:: with std::execution::seq and ::par (which GCC hands off to TBB, so...
+// ...link with -ltbb), then par:: with par::execution::par and ::par_unseq
+
+// range(0) is the length
+#define BENCH_ARGS ->Arg(1 << 16)->Arg(1 << 22)->UseRealTime()
+
+std::vector<double> make_input(std::size_t n) { return bench::make_input<double>(n, 0.0, 1.0); }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+template <typename Policy>
+void bm_for_each(benchmark::State &state, Policy policy) {
+    auto dvec = make_input(state.range(0));
+    for (auto _ : state) {
+        CALL(for_each, policy, dvec.begin(), dvec.end(), [] (double &d) { d = std::sqrt(d * d + 1.0); });
+        benchmark::DoNotOptimize(dvec.data());
+    }
+} REGISTER_WITH_PAR_UNSEQ(bm_for_each);
+
+template <typename Policy>
+void bm_transform(benchmark::State &state, Policy policy) {
+    auto dvec = make_input(state.range(0)), out = dvec;
+    for (auto _ : state) {
+        CALL(transform, policy, dvec.begin(), dvec.end(), out.begin(), [] (double d) { return 2.0 * d + 1.0; });
+        benchmark::DoNotOptimize(out.data());
+    }
+} REGISTER_WITH_PAR_UNSEQ(bm_transform);
+
+template <typename Policy>
+void bm_reduce(benchmark::State &state, Policy policy) {
+    auto dvec = make_input(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(CALL(reduce, policy, dvec.begin(), dvec.end(), 0.0));
+    }
+} REGISTER_WITH_PAR_UNSEQ(bm_reduce);
+
+template <typename Policy>
+void bm_transform_reduce(benchmark::State &state, Policy policy) {
+    auto dvec = make_input(state.range(0)), dvec2 = make_input(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(CALL(transform_reduce, policy, dvec.begin(), dvec.end(), dvec2.begin(), 0.0));
+    }
+} REGISTER_WITH_PAR_UNSEQ(bm_transform_reduce);
+
+template <typename Policy>
+void bm_inclusive_scan(benchmark::State &state, Policy policy) {
+    auto dvec = make_input(state.range(0)), out = dvec;
+    for (auto _ : state) {
+        CALL(inclusive_scan, policy, dvec.begin(), dvec.end(), out.begin());
+        benchmark::DoNotOptimize(out.data());
+    }
+} REGISTER_WITH_PAR_UNSEQ(bm_inclusive_scan);
+
+template <typename Policy>
+void bm_exclusive_scan(benchmark::State &state, Policy policy) {
+    auto dvec = make_input(state.range(0)), out = dvec;
+    for (auto _ : state) {
+        CALL(exclusive_scan, policy, dvec.begin(), dvec.end(), out.begin(), 0.0);
+        benchmark::DoNotOptimize(out.data());
+    }
+} REGISTER_WITH_PAR_UNSEQ(bm_exclusive_scan);
+
+// nothing matches, so everyone has to look at everything
+template <typename Policy>
+void bm_find_if(benchmark::State &state, Policy policy) {
+    auto dvec = make_input(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(CALL(find_if, policy, dvec.begin(), dvec.end(), [] (double d) { return d > 1.0; }));
+    }
+} REGISTER_WITH_PAR_UNSEQ(bm_find_if);
+
+template <typename Policy>
+void bm_count_if(benchmark::State &state, Policy policy) {
+    auto dvec = make_input(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(CALL(count_if, policy, dvec.begin(), dvec.end(), [] (double d) { return d < 0.5; }));
+    }
+} REGISTER_WITH_PAR_UNSEQ(bm_count_if);
+
+template <typename Policy>
+void bm_sort(benchmark::State &state, Policy policy) {
+    auto input = make_input(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto dvec = input;
+        state.ResumeTiming();
+
+        CALL(sort, policy, dvec.begin(), dvec.end());
+        benchmark::DoNotOptimize(dvec.data());
+    }
+} REGISTER_WITH_PAR_UNSEQ(bm_sort);
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int main(int argc, char **argv)
+{
+    // quick sanity check before timing anything - every par:: result against its std:: namesake
+    auto dvec = make_input(1 << 20);
+    std::vector<double> a(dvec.size()), b(dvec.size());
+
+    auto check = [] (const char *name, bool ok) { std::cout << name << (ok ? "ok" : "MISMATCH") << '\n'; };
+
+    // sums of doubles depend on the order they're added in, so compare those with a little slack
+    auto close = [] (double x, double y) { return std::abs(x - y) <= 1e-9 * std::abs(y); };
+
+    par::transform(par::execution::par, dvec.begin(), dvec.end(), a.begin(), [] (double d) { return d * 2; });
+    std::transform(dvec.begin(), dvec.end(), b.begin(), [] (double d) { return d * 2; });
+    check("transform:        ", a == b);
+
+    check("reduce:           ", close(par::reduce(par::execution::par, dvec.begin(), dvec.end()), std::reduce(dvec.begin(), dvec.end())));
+    check("transform_reduce: ", close(par::transform_reduce(par::execution::par_unseq, dvec.begin(), dvec.end(), dvec.begin(), 0.0),
+                                      std::transform_reduce(dvec.begin(), dvec.end(), dvec.begin(), 0.0)));
+
+    par::inclusive_scan(par::execution::par, dvec.begin(), dvec.end(), a.begin());
+    std::inclusive_scan(dvec.begin(), dvec.end(), b.begin());
+    check("inclusive_scan:   ", std::equal(a.begin(), a.end(), b.begin(), close));
+
+    par::exclusive_scan(par::execution::par, dvec.begin(), dvec.end(), a.begin(), 1.0);
+    std::exclusive_scan(dvec.begin(), dvec.end(), b.begin(), 1.0);
+    check("exclusive_scan:   ", std::equal(a.begin(), a.end(), b.begin(), close));
+
+    auto big = [] (double d) { return d > 0.999999; };
+    check("find_if:          ", par::find_if(par::execution::par, dvec.begin(), dvec.end(), big) == std::find_if(dvec.begin(), dvec.end(), big));
+
+    auto small = [] (double d) { return d < 0.5; };
+    check("count_if:         ", par::count_if(par::execution::par, dvec.begin(), dvec.end(), small) == std::count_if(dvec.begin(), dvec.end(), small));
+
+    a = dvec, b = dvec;
+    par::sort(par::execution::par, a.begin(), a.end());
+    std::sort(b.begin(), b.end());
+    check("sort:             ", a == b);
+
+    std::cout << '\n';
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//  OUTPUT - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// transform:        ok
+// reduce:           ok
+// transform_reduce: ok
+// inclusive_scan:   ok
+// exclusive_scan:   ok
+// find_if:          ok
+// count_if:         ok
+// sort:             ok
+//
+// Run on (1 X 2100 MHz CPU )
+// CPU Caches:
+//   L1 Data 48 KiB (x1)
+//   L1 Instruction 32 KiB (x1)
+//   L2 Unified 2048 KiB (x1)
+//   L3 Unified 307200 KiB (x1)
+// Load Average: 1.03, 0.99, 0.79
+// ----------------------------------------------------------------------------------------------
+// Benchmark                                                    Time             CPU   Iterations
+// ----------------------------------------------------------------------------------------------
+// bm_for_each/std_seq/65536/real_time                     132017 ns       131675 ns         2096
+// bm_for_each/std_seq/4194304/real_time                  8717868 ns      8623588 ns           32
+// bm_for_each/std_par/65536/real_time                     134448 ns       134104 ns         2076
+// bm_for_each/std_par/4194304/real_time                  8971239 ns      8897979 ns           32
+// bm_for_each/par_par/65536/real_time                     137351 ns        78790 ns         2044
+// bm_for_each/par_par/4194304/real_time                  8902436 ns      4733323 ns           30
+// bm_for_each/par_par_unseq/65536/real_time               144036 ns        82773 ns         1988
+// bm_for_each/par_par_unseq/4194304/real_time            9114256 ns      4680590 ns           32
+// bm_transform/std_seq/65536/real_time                     61442 ns        58685 ns         3966
+// bm_transform/std_seq/4194304/real_time                 3334307 ns      3278236 ns           73
+// bm_transform/std_par/65536/real_time                     46873 ns        46406 ns         5984
+// bm_transform/std_par/4194304/real_time                 2888350 ns      2849636 ns           86
+// bm_transform/par_par/65536/real_time                     41379 ns        25494 ns         6817
+// bm_transform/par_par/4194304/real_time                 3527548 ns      1933439 ns           80
+// bm_transform/par_par_unseq/65536/real_time               31955 ns        20765 ns         8842
+// bm_transform/par_par_unseq/4194304/real_time           3741199 ns      2130717 ns           95
+// bm_reduce/std_seq/65536/real_time                        16004 ns        15853 ns        16672
+// bm_reduce/std_seq/4194304/real_time                    1495665 ns      1489979 ns          135
+// bm_reduce/std_par/65536/real_time                        16913 ns        16764 ns        15913
+// bm_reduce/std_par/4194304/real_time                    1579226 ns      1575533 ns          140
+// bm_reduce/par_par/65536/real_time                        19207 ns        12447 ns        15908
+// bm_reduce/par_par/4194304/real_time                    1599792 ns       825605 ns          135
+// bm_reduce/par_par_unseq/65536/real_time                  24086 ns        15788 ns        11706
+// bm_reduce/par_par_unseq/4194304/real_time              1706478 ns       927886 ns          158
+// bm_transform_reduce/std_seq/65536/real_time              48562 ns        48364 ns         5851
+// bm_transform_reduce/std_seq/4194304/real_time          3480501 ns      3344753 ns           71
+// bm_transform_reduce/std_par/65536/real_time              48583 ns        47608 ns         5342
+// bm_transform_reduce/std_par/4194304/real_time          3512734 ns      3493609 ns           82
+// bm_transform_reduce/par_par/65536/real_time              33563 ns        21694 ns         8734
+// bm_transform_reduce/par_par/4194304/real_time          3545663 ns      1939784 ns           95
+// bm_transform_reduce/par_par_unseq/65536/real_time        38522 ns        25014 ns         6922
+// bm_transform_reduce/par_par_unseq/4194304/real_time    5254491 ns      2726372 ns           42
+// bm_inclusive_scan/std_seq/65536/real_time                47005 ns        46790 ns         5760
+// bm_inclusive_scan/std_seq/4194304/real_time            5659761 ns      5607857 ns           41
+// bm_inclusive_scan/std_par/65536/real_time                82187 ns        81816 ns         3692
+// bm_inclusive_scan/std_par/4194304/real_time            8580846 ns      8505336 ns           25
+// bm_inclusive_scan/par_par/65536/real_time                70356 ns        46856 ns         3806
+// bm_inclusive_scan/par_par/4194304/real_time            6478426 ns      4517710 ns           31
+// bm_inclusive_scan/par_par_unseq/65536/real_time          69743 ns        46688 ns         3894
+// bm_inclusive_scan/par_par_unseq/4194304/real_time      5749196 ns      3971149 ns           37
+// bm_exclusive_scan/std_seq/65536/real_time                45764 ns        45385 ns         6015
+// bm_exclusive_scan/std_seq/4194304/real_time            7048036 ns      7035974 ns           36
+// bm_exclusive_scan/std_par/65536/real_time                72555 ns        72106 ns         3280
+// bm_exclusive_scan/std_par/4194304/real_time            9164458 ns      9147744 ns           24
+// bm_exclusive_scan/par_par/65536/real_time                81744 ns        56158 ns         3742
+// bm_exclusive_scan/par_par/4194304/real_time            6562399 ns      4468466 ns           36
+// bm_exclusive_scan/par_par_unseq/65536/real_time          70609 ns        46454 ns         3762
+// bm_exclusive_scan/par_par_unseq/4194304/real_time      7140713 ns      4833428 ns           33
+// bm_find_if/std_seq/65536/real_time                       26499 ns        26262 ns        10530
+// bm_find_if/std_seq/4194304/real_time                   1929892 ns      1922090 ns          117
+// bm_find_if/std_par/65536/real_time                       29055 ns        28762 ns         9703
+// bm_find_if/std_par/4194304/real_time                   2400425 ns      2384339 ns           92
+// bm_find_if/par_par/65536/real_time                       34010 ns        17476 ns         7609
+// bm_find_if/par_par/4194304/real_time                   1862939 ns       928517 ns          121
+// bm_find_if/par_par_unseq/65536/real_time                 29790 ns        15200 ns         9797
+// bm_find_if/par_par_unseq/4194304/real_time             2722585 ns      1337744 ns          117
+// bm_count_if/std_seq/65536/real_time                      60900 ns        60722 ns         6278
+// bm_count_if/std_seq/4194304/real_time                  3057907 ns      3045232 ns           78
+// bm_count_if/std_par/65536/real_time                      51963 ns        51792 ns         5990
+// bm_count_if/std_par/4194304/real_time                  4144110 ns      4072113 ns           50
+// bm_count_if/par_par/65536/real_time                      40671 ns        25898 ns         6725
+// bm_count_if/par_par/4194304/real_time                  2710169 ns      1573548 ns           77
+// bm_count_if/par_par_unseq/65536/real_time                40271 ns        25649 ns         6821
+// bm_count_if/par_par_unseq/4194304/real_time            2665394 ns      1441481 ns           90
+// bm_sort/std_seq/65536/real_time                        4652493 ns      4570733 ns           59
+// bm_sort/std_seq/4194304/real_time                    396452136 ns    395468761 ns            1
+// bm_sort/std_par/65536/real_time                        5601076 ns      5549551 ns           44
+// bm_sort/std_par/4194304/real_time                    547199793 ns    544308609 ns            1
+// bm_sort/par_par/65536/real_time                        4028025 ns      2143864 ns           68
+// bm_sort/par_par/4194304/real_time                    409460893 ns    206869534 ns            1
+// bm_sort/par_par_unseq/65536/real_time                  4079472 ns      2134577 ns           68
+// bm_sort/par_par_unseq/4194304/real_time              497501073 ns    246099928 ns            1
+// Program ended with exit code: 0
@@ -0,0 +1,153 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "bench.h"
+#include "par.h"
+
+std::vector<int> make_input(std::size_t n) { return bench::make_input<int>(n, 0, std::numeric_limits<int>::max()); }
+
+template <typename T>
+void printVec(const std::vector<T> &vec) {
+    for (const auto &t : vec) {
+        std::cout << t << ' ';
+    } std::cout << '\n';
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// range(0) is how far into the range the nth element is, in percent
+
+// what we'd have done before - sort the lot, just to look at one element
+static void bm_sort_then_pick(benchmark::State &state) {
+    auto input = make_input(1 << 22);
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto ivec = input;
+        state.ResumeTiming();
+
+        par::sort(par::execution::par, ivec.begin(), ivec.end());
+        benchmark::DoNotOptimize(ivec[ivec.size() * state.range(0) / 100]);
+    }
+} BENCHMARK(bm_sort_then_pick)->Arg(1)->Arg(50)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void bm_std_nth_element(benchmark::State &state) {
+    auto input = make_input(1 << 22);
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto ivec = input;
+        state.ResumeTiming();
+
+        std::nth_element(ivec.begin(), ivec.begin() + ivec.size() * state.range(0) / 100, ivec.end());
+        benchmark::DoNotOptimize(ivec.data());
+    }
+} BENCHMARK(bm_std_nth_element)->Arg(1)->Arg(50)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void bm_par_nth_element(benchmark::State &state) {
+    auto input = make_input(1 << 22);
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto ivec = input;
+        state.ResumeTiming();
+
+        par::nth_element(par::execution::par, ivec.begin(), ivec.begin() + ivec.size() * state.range(0) / 100, ivec.end());
+        benchmark::DoNotOptimize(ivec.data());
+    }
+} BENCHMARK(bm_par_nth_element)->Arg(1)->Arg(50)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// range(0) is k
+static void bm_std_partial_sort_copy(benchmark::State &state) {
+    auto ivec = make_input(1 << 22);
+    std::vector<int> top(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::partial_sort_copy(ivec.begin(), ivec.end(), top.begin(), top.end(), std::greater<>()));
+    }
+} BENCHMARK(bm_std_partial_sort_copy)->Arg(10)->Arg(10000)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void bm_seq_top_k(benchmark::State &state) {
+    auto ivec = make_input(1 << 22);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(par::partial_sort_top_k(par::execution::seq, ivec.begin(), ivec.end(), state.range(0)));
+    }
+} BENCHMARK(bm_seq_top_k)->Arg(10)->Arg(10000)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void bm_par_top_k(benchmark::State &state) {
+    auto ivec = make_input(1 << 22);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(par::partial_sort_top_k(par::execution::par, ivec.begin(), ivec.end(), state.range(0)));
+    }
+} BENCHMARK(bm_par_top_k)->Arg(10)->Arg(10000)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int main(int argc, char **argv)
+{
+    auto ivec = make_input(1 << 22);
+
+    auto sorted = ivec;
+    std::sort(sorted.begin(), sorted.end());
+
+    // the median, and everything either side of it on the right side
+    auto median = ivec;
+    auto nth = median.begin() + median.size() / 2;
+    par::nth_element(par::execution::par, median.begin(), nth, median.end());
+
+    bool partitioned = std::all_of(median.begin(), nth, [&] (int i) { return i <= *nth; })
+                    && std::all_of(nth, median.end(), [&] (int i) { return i >= *nth; });
+
+    std::cout << "median:      " << *nth << (*nth == sorted[sorted.size() / 2] && partitioned ? " (ok)" : " (NOT ok)") << '\n';
+
+    // the ten largest, biggest first
+    auto top = par::partial_sort_top_k(par::execution::par, ivec.begin(), ivec.end(), 10);
+    std::cout << "top 10:      "; printVec(top);
+    std::cout << "             " << (std::equal(top.begin(), top.end(), sorted.rbegin()) ? "matches" : "DOESN'T match") << " the end of std::sort\n";
+
+    // ...or the smallest, with the comparator turned around
+    auto bottom = par::partial_sort_top_k(par::execution::par, ivec.begin(), ivec.end(), 10, std::less<>());
+    std::cout << "bottom 10:   "; printVec(bottom);
+    std::cout << "             " << (std::equal(bottom.begin(), bottom.end(), sorted.begin()) ? "matches" : "DOESN'T match") << " the start of std::sort\n\n";
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//  OUTPUT - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// median:      1073646328 (ok)
+// top 10:      2147482320 2147482168 2147481871 2147480020 2147478895 2147478314 2147477023 2147475890 2147475688 2147475528 
+//              matches the end of std::sort
+// bottom 10:   309 813 1085 1114 1776 2939 3298 4781 4886 4906 
+//              matches the start of std::sort
+//
+// Run on (1 X 2100 MHz CPU )
+// CPU Caches:
+//   L1 Data 48 KiB (x1)
+//   L1 Instruction 32 KiB (x1)
+//   L2 Unified 2048 KiB (x1)
+//   L3 Unified 307200 KiB (x1)
+// Load Average: 1.36, 1.03, 0.92
+// -----------------------------------------------------------------------------------
+// Benchmark                                         Time             CPU   Iterations
+// -----------------------------------------------------------------------------------
+// bm_sort_then_pick/1/real_time                   320 ms          163 ms            2
+// bm_sort_then_pick/50/real_time                  301 ms          152 ms            2
+// bm_std_nth_element/1/real_time                 29.6 ms         29.4 ms           22
+// bm_std_nth_element/50/real_time                35.8 ms         35.6 ms           21
+// bm_par_nth_element/1/real_time                 5.54 ms         4.05 ms          124
+// bm_par_nth_element/50/real_time                23.1 ms         13.1 ms           29
+// bm_std_partial_sort_copy/10/real_time          1.37 ms         1.36 ms          561
+// bm_std_partial_sort_copy/10000/real_time       8.60 ms         8.30 ms           85
+// bm_seq_top_k/10/real_time                      1.37 ms         1.36 ms          527
+// bm_seq_top_k/10000/real_time                   8.77 ms         8.69 ms           78
+// bm_par_top_k/10/real_time                      1.43 ms        0.759 ms          513
+// bm_par_top_k/10000/real_time                   13.4 ms         7.36 ms           50
+// Program ended with exit code: 0
@@ -0,0 +1,175 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <execution>
+#include <iostream>
+#include <vector>
+
+#include "bench.h"
+#include "par.h"
+
+// range(0) is the length of each list
+#define BENCH_ARGS ->Arg(1 << 16)->Arg(1 << 22)->UseRealTime()
+
+// a sorted list of n ids out of [0, 2n) - so two lists share about a third of their ids, and each has a few repeats
+std::vector<std::uint32_t> make_ids(std::size_t n, unsigned seed) {
+    auto ids = bench::make_input<std::uint32_t>(n, 0, 2 * n - 1, seed);
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+template <typename T>
+void printVec(const std::vector<T> &vec) {
+    for (const auto &t : vec) {
+        std::cout << t << ' ';
+    } std::cout << '\n';
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+template <typename Policy>
+void bm_merge(benchmark::State &state, Policy policy) {
+    auto a = make_ids(state.range(0), 1), b = make_ids(state.range(0), 2);
+    std::vector<std::uint32_t> out(a.size() + b.size());
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(CALL(merge, policy, a.begin(), a.end(), b.begin(), b.end(), out.begin()));
+    }
+} REGISTER(bm_merge);
+
+// GCC 12's std::set_union and std::set_intersection don't even compile with std::execution::par (somewhere inside the...
+// ...pstl, a const policy gets bound to a non-const reference), so those two go without
+template <typename Policy>
+void bm_set_union(benchmark::State &state, Policy policy) {
+    auto a = make_ids(state.range(0), 1), b = make_ids(state.range(0), 2);
+    std::vector<std::uint32_t> out(a.size() + b.size());
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(CALL(set_union, policy, a.begin(), a.end(), b.begin(), b.end(), out.begin()));
+    }
+} REGISTER_WITHOUT_STD_PAR(bm_set_union);
+
+template <typename Policy>
+void bm_set_intersection(benchmark::State &state, Policy policy) {
+    auto a = make_ids(state.range(0), 1), b = make_ids(state.range(0), 2);
+    std::vector<std::uint32_t> out(a.size());
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(CALL(set_intersection, policy, a.begin(), a.end(), b.begin(), b.end(), out.begin()));
+    }
+} REGISTER_WITHOUT_STD_PAR(bm_set_intersection);
+
+template <typename Policy>
+void bm_unique(benchmark::State &state, Policy policy) {
+    auto input = make_ids(state.range(0), 1);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto ids = input;
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(CALL(unique, policy, ids.begin(), ids.end()));
+    }
+} REGISTER(bm_unique);
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int main(int argc, char **argv)
+{
+    std::vector<int> a { 1, 2, 2, 4, 5, 7, 9 }, b { 2, 3, 4, 4, 8, 9 };
+    std::vector<int> out(a.size() + b.size());
+
+    std::cout << "a:                "; printVec(a);
+    std::cout << "b:                "; printVec(b);
+
+    out.erase(par::merge(par::execution::par, a.begin(), a.end(), b.begin(), b.end(), out.begin()), out.end());
+    std::cout << "merge:            "; printVec(out);
+
+    out.resize(a.size() + b.size());
+    out.erase(par::set_union(par::execution::par, a.begin(), a.end(), b.begin(), b.end(), out.begin()), out.end());
+    std::cout << "set_union:        "; printVec(out);
+
+    out.resize(a.size() + b.size());
+    out.erase(par::set_intersection(par::execution::par, a.begin(), a.end(), b.begin(), b.end(), out.begin()), out.end());
+    std::cout << "set_intersection: "; printVec(out);
+
+    out = a;
+    out.erase(par::unique(par::execution::par, out.begin(), out.end()), out.end());
+    std::cout << "unique(a):        "; printVec(out);
+
+    // big enough to be split across the pool - every result against its std:: namesake
+    auto x = make_ids(1 << 22, 1), y = make_ids(1 << 22, 2);
+    std::vector<std::uint32_t> p(x.size() + y.size()), q(x.size() + y.size());
+
+    auto check = [&] (const char *name, auto p_end, auto q_end) {
+        std::cout << name << (std::equal(p.begin(), p_end, q.begin(), q_end) ? "matches" : "DOESN'T match") << '\n';
+    };
+
+    std::cout << "\n4M ids each\n";
+    check("merge:            ", par::merge(par::execution::par, x.begin(), x.end(), y.begin(), y.end(), p.begin()),
+                                std::merge(x.begin(), x.end(), y.begin(), y.end(), q.begin()));
+    check("set_union:        ", par::set_union(par::execution::par, x.begin(), x.end(), y.begin(), y.end(), p.begin()),
+                                std::set_union(x.begin(), x.end(), y.begin(), y.end(), q.begin()));
+    check("set_intersection: ", par::set_intersection(par::execution::par, x.begin(), x.end(), y.begin(), y.end(), p.begin()),
+                                std::set_intersection(x.begin(), x.end(), y.begin(), y.end(), q.begin()));
+
+    p = x, q = x;
+    check("unique:           ", par::unique(par::execution::par, p.begin(), p.end()), std::unique(q.begin(), q.end()));
+    std::cout << '\n';
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//  OUTPUT - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// a:                1 2 2 4 5 7 9 
+// b:                2 3 4 4 8 9 
+// merge:            1 2 2 2 3 4 4 4 5 7 8 9 9 
+// set_union:        1 2 2 3 4 4 5 7 8 9 
+// set_intersection: 2 4 9 
+// unique(a):        1 2 4 5 7 9 
+//
+// 4M ids each
+// merge:            matches
+// set_union:        matches
+// set_intersection: matches
+// unique:           matches
+//
+// Run on (1 X 2100 MHz CPU )
+// CPU Caches:
+//   L1 Data 48 KiB (x1)
+//   L1 Instruction 32 KiB (x1)
+//   L2 Unified 2048 KiB (x1)
+//   L3 Unified 307200 KiB (x1)
+// Load Average: 1.18, 0.99, 0.91
+// ----------------------------------------------------------------------------------------
+// Benchmark                                              Time             CPU   Iterations
+// ----------------------------------------------------------------------------------------
+// bm_merge/std_seq/65536/real_time                  624915 ns       612557 ns         1063
+// bm_merge/std_seq/4194304/real_time              47575715 ns     47024288 ns           16
+// bm_merge/std_par/65536/real_time                  718967 ns       710044 ns          819
+// bm_merge/std_par/4194304/real_time              43680185 ns     43131228 ns           12
+// bm_merge/par_par/65536/real_time                  595799 ns       314909 ns         1168
+// bm_merge/par_par/4194304/real_time              48565809 ns     23852579 ns           16
+// bm_set_union/std_seq/65536/real_time              609605 ns       606072 ns          960
+// bm_set_union/std_seq/4194304/real_time          51342251 ns     50793280 ns           10
+// bm_set_union/par_par/65536/real_time              866013 ns       471887 ns          898
+// bm_set_union/par_par/4194304/real_time          51599732 ns     27236110 ns           12
+// bm_set_intersection/std_seq/65536/real_time       768518 ns       762441 ns          927
+// bm_set_intersection/std_seq/4194304/real_time   50611418 ns     50432651 ns           10
+// bm_set_intersection/par_par/65536/real_time       704542 ns       418252 ns         1018
+// bm_set_intersection/par_par/4194304/real_time   48785220 ns     23289818 ns           11
+// bm_unique/std_seq/65536/real_time                 235057 ns       226574 ns         3212
+// bm_unique/std_seq/4194304/real_time             13620472 ns     13529267 ns           52
+// bm_unique/std_par/65536/real_time                 287187 ns       285523 ns         2282
+// bm_unique/std_par/4194304/real_time             22841335 ns     22431619 ns           32
+// bm_unique/par_par/65536/real_time                 182566 ns       113352 ns         3348
+// bm_unique/par_par/4194304/real_time             15824397 ns      8493695 ns           46
+// Program ended with exit code: 0
@@ -0,0 +1,160 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <execution>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include "bench.h"
+#include "par.h"
+
+// range(0) is the length, range(1) is the percentage of elements the predicate says yes to
+#define BENCH_ARGS ->ArgsProduct({ { 1 << 22 }, { 1, 50, 99 } })->UseRealTime()
+
+std::vector<int> make_input(std::size_t n) { return bench::make_input<int>(n, 0, 99); }
+
+template <typename T>
+void printVec(const std::vector<T> &vec) {
+    for (const auto &t : vec) {
+        std::cout << t << ' ';
+    } std::cout << '\n';
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+template <typename Policy>
+void bm_copy_if(benchmark::State &state, Policy policy) {
+    auto ivec = make_input(state.range(0)), out = ivec;
+    int percent = state.range(1);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(CALL(copy_if, policy, ivec.begin(), ivec.end(), out.begin(), [=] (int i) { return i < percent; }));
+    }
+} REGISTER(bm_copy_if);
+
+template <typename Policy>
+void bm_remove_if(benchmark::State &state, Policy policy) {
+    auto input = make_input(state.range(0));
+    int percent = state.range(1);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto ivec = input;
+        state.ResumeTiming();
+
+        // remove everything the others would have kept, so "1%" keeps 99% here (and vice versa)
+        benchmark::DoNotOptimize(CALL(remove_if, policy, ivec.begin(), ivec.end(), [=] (int i) { return i < percent; }));
+    }
+} REGISTER(bm_remove_if);
+
+template <typename Policy>
+void bm_partition(benchmark::State &state, Policy policy) {
+    auto input = make_input(state.range(0));
+    int percent = state.range(1);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto ivec = input;
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(CALL(partition, policy, ivec.begin(), ivec.end(), [=] (int i) { return i < percent; }));
+    }
+} REGISTER(bm_partition);
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int main(int argc, char **argv)
+{
+    std::vector<int> ivec(20);
+    std::iota(ivec.begin(), ivec.end(), 1);
+
+    auto even = [] (int i) { return i % 2 == 0; };
+
+    std::vector<int> evens(ivec.size());
+    evens.erase(par::copy_if(par::execution::par, ivec.begin(), ivec.end(), evens.begin(), even), evens.end());
+
+    std::vector<int> odds = ivec;
+    odds.erase(par::remove_if(par::execution::par, odds.begin(), odds.end(), even), odds.end());
+
+    std::cout << "ivec:      "; printVec(ivec);
+    std::cout << "copy_if:   "; printVec(evens);
+    std::cout << "remove_if: "; printVec(odds);
+
+    // big enough to be split across the pool - every result against its std:: namesake
+    auto big = make_input(1 << 22);
+    auto small = [] (int i) { return i < 30; };
+
+    std::vector<int> a(big.size()), b(big.size());
+    auto a_end = par::copy_if(par::execution::par, big.begin(), big.end(), a.begin(), small);
+    auto b_end = std::copy_if(big.begin(), big.end(), b.begin(), small);
+    std::cout << "\n4M ints\ncopy_if:   " << (std::equal(a.begin(), a_end, b.begin(), b_end) ? "matches" : "DOESN'T match") << " std::copy_if\n";
+
+    a = big, b = big;
+    a_end = par::remove_if(par::execution::par, a.begin(), a.end(), small);
+    b_end = std::remove_if(b.begin(), b.end(), small);
+    std::cout << "remove_if: " << (std::equal(a.begin(), a_end, b.begin(), b_end) ? "matches" : "DOESN'T match") << " std::remove_if\n";
+
+    a = big;
+    a_end = par::partition(par::execution::par, a.begin(), a.end(), small);
+    std::cout << "partition: " << (std::is_partitioned(a.begin(), a.end(), small)
+                                   && a_end - a.begin() == std::count_if(big.begin(), big.end(), small) ? "ok" : "NOT ok") << "\n\n";
+
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//  OUTPUT - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// ivec:      1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20 
+// copy_if:   2 4 6 8 10 12 14 16 18 20 
+// remove_if: 1 3 5 7 9 11 13 15 17 19 
+//
+// 4M ints
+// copy_if:   matches std::copy_if
+// remove_if: matches std::remove_if
+// partition: ok
+//
+// Run on (1 X 2100 MHz CPU )
+// CPU Caches:
+//   L1 Data 48 KiB (x1)
+//   L1 Instruction 32 KiB (x1)
+//   L2 Unified 2048 KiB (x1)
+//   L3 Unified 307200 KiB (x1)
+// Load Average: 0.91, 0.91, 0.82
+// ------------------------------------------------------------------------------------
+// Benchmark                                          Time             CPU   Iterations
+// ------------------------------------------------------------------------------------
+// bm_copy_if/std_seq/4194304/1/real_time       4496463 ns      4362268 ns           82
+// bm_copy_if/std_seq/4194304/50/real_time     20331093 ns     20224491 ns           13
+// bm_copy_if/std_seq/4194304/99/real_time      2722401 ns      2684831 ns          118
+// bm_copy_if/std_par/4194304/1/real_time      11658434 ns     11578198 ns           37
+// bm_copy_if/std_par/4194304/50/real_time     28328117 ns     27882293 ns           10
+// bm_copy_if/std_par/4194304/99/real_time      6208269 ns      6180033 ns           46
+// bm_copy_if/par_par/4194304/1/real_time       5165833 ns      3084028 ns           58
+// bm_copy_if/par_par/4194304/50/real_time     20970003 ns     10595434 ns           13
+// bm_copy_if/par_par/4194304/99/real_time      3577756 ns      1945390 ns           77
+// bm_remove_if/std_seq/4194304/1/real_time     1994834 ns      1994034 ns          131
+// bm_remove_if/std_seq/4194304/50/real_time   19536231 ns     19394495 ns           14
+// bm_remove_if/std_seq/4194304/99/real_time    3431927 ns      3319636 ns           82
+// bm_remove_if/std_par/4194304/1/real_time     8349285 ns      8349240 ns           29
+// bm_remove_if/std_par/4194304/50/real_time   27465769 ns     26911501 ns           10
+// bm_remove_if/std_par/4194304/99/real_time    7490794 ns      7480762 ns           35
+// bm_remove_if/par_par/4194304/1/real_time     3299886 ns      2091264 ns           80
+// bm_remove_if/par_par/4194304/50/real_time   22781802 ns     11632887 ns           13
+// bm_remove_if/par_par/4194304/99/real_time    4726405 ns      2910266 ns           57
+// bm_partition/std_seq/4194304/1/real_time     2503186 ns      2467307 ns          125
+// bm_partition/std_seq/4194304/50/real_time   19355742 ns     19055767 ns           14
+// bm_partition/std_seq/4194304/99/real_time    2495548 ns      2470797 ns          112
+// bm_partition/std_par/4194304/1/real_time     2399948 ns      2383859 ns          117
+// bm_partition/std_par/4194304/50/real_time   22162214 ns     21957680 ns           13
+// bm_partition/std_par/4194304/99/real_time    4251213 ns      4170919 ns           54
+// bm_partition/par_par/4194304/1/real_time     2173830 ns      1389753 ns          121
+// bm_partition/par_par/4194304/50/real_time   21221415 ns     10807065 ns           13
+// bm_partition/par_par/4194304/99/real_time    2349647 ns      1450363 ns          116
+// Program ended with exit code: 0
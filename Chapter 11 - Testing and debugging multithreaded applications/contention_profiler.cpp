@@ -0,0 +1,394 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <source_location>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace prof {
+constexpr std::size_t max_sites = 64;
+constexpr std::size_t num_buckets = 40; // log2(ns) - bucket b holds [2^(b-1), 2^b) ns
+constexpr std::uint64_t hold_sample_rate = 16; // time 1 in every 16 uncontended holds
+
+typedef std::chrono::steady_clock clock_type;
+
+inline std::uint64_t ns_since(clock_type::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start).count();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// per-thread, per-site counters - only the owning thread ever writes to them,...
+// ...so a relaxed load + store is enough (no lock prefix), and report() can read them from any thread
+struct site_stats {
+    std::atomic<std::uint64_t> acquisitions{0};
+    std::atomic<std::uint64_t> contended{0};
+    std::atomic<std::uint64_t> wait_ns{0};
+    std::atomic<std::uint64_t> hold_samples{0};
+    std::atomic<std::uint64_t> hold_ns{0};
+    std::array<std::atomic<std::uint64_t>, num_buckets> wait_hist{};
+    std::array<std::atomic<std::uint64_t>, num_buckets> hold_hist{};
+};
+
+inline void bump(std::atomic<std::uint64_t> &counter, std::uint64_t by = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+}
+
+inline std::size_t bucket_for(std::uint64_t ns) {
+    return std::min<std::size_t>(std::bit_width(ns), num_buckets - 1);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+class registry {
+public:
+    static registry& instance()
+    {
+        static registry r;
+        return r;
+    }
+
+    // mutexes with the same name share a site (e.g. every bucket in a ts::map)
+    std::size_t site_for(const std::string &name)
+    {
+        std::lock_guard lock(m_);
+
+        auto it = std::find(names_.begin(), names_.end(), name);
+        if (it != names_.end()) { return it - names_.begin(); }
+
+        // the last slot's kept back for everything past the first max_sites - 1 names, and reported as "(other)"...
+        // ...rather than quietly adding them onto whichever site happened to get there last
+        if (names_.size() >= other_site) {
+            if (names_.size() == other_site) { names_.push_back("(other)"); }
+            return other_site;
+        }
+
+        names_.push_back(name);
+        return names_.size() - 1;
+    }
+
+    site_stats& stats(std::size_t site)
+    {
+        // first lock on a new thread registers its table; the shared_ptr keeps it alive after the thread exits
+        static thread_local std::shared_ptr<std::array<site_stats, max_sites>> table = register_thread();
+        return (*table)[site];
+    }
+
+    void report(std::ostream &os)
+    {
+        std::lock_guard lock(m_);
+
+        struct merged {
+            std::string name;
+            std::uint64_t acquisitions = 0, contended = 0, wait_ns = 0, hold_samples = 0, hold_ns = 0;
+            std::array<std::uint64_t, num_buckets> wait_hist{}, hold_hist{};
+        };
+
+        std::vector<merged> sites(names_.size());
+
+        for (std::size_t i = 0; i != sites.size(); ++i) {
+            sites[i].name = names_[i];
+
+            for (auto &table : tables_) {
+                const site_stats &s = (*table)[i];
+                sites[i].acquisitions += s.acquisitions.load(std::memory_order_relaxed);
+                sites[i].contended    += s.contended.load(std::memory_order_relaxed);
+                sites[i].wait_ns      += s.wait_ns.load(std::memory_order_relaxed);
+                sites[i].hold_samples += s.hold_samples.load(std::memory_order_relaxed);
+                sites[i].hold_ns      += s.hold_ns.load(std::memory_order_relaxed);
+
+                for (std::size_t b = 0; b != num_buckets; ++b) {
+                    sites[i].wait_hist[b] += s.wait_hist[b].load(std::memory_order_relaxed);
+                    sites[i].hold_hist[b] += s.hold_hist[b].load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // hottest lock first
+        std::sort(sites.begin(), sites.end(), [] (const merged &a, const merged &b) { return a.wait_ns > b.wait_ns; });
+
+        os << std::left << std::setw(32) << "lock site" << std::right
+           << std::setw(10) << "acquired" << std::setw(11) << "contended" << std::setw(9) << "%"
+           << std::setw(13) << "total wait" << std::setw(14) << "p99 wait"
+           << std::setw(10) << "avg hold" << std::setw(14) << "p99 hold" << '\n';
+
+        for (const merged &s : sites) {
+            os << std::left << std::setw(32) << s.name << std::right
+               << std::setw(10) << s.acquisitions
+               << std::setw(11) << s.contended
+               << std::setw(8) << std::fixed << std::setprecision(3)
+               << (s.acquisitions ? 100.0 * s.contended / s.acquisitions : 0.0) << '%'
+               << std::setw(11) << s.wait_ns / 1000 << "us"
+               << std::setw(4) << "< " << std::setw(10) << percentile(s.wait_hist, s.contended, 0.99) << "ns"
+               << std::setw(8) << (s.hold_samples ? s.hold_ns / s.hold_samples : 0) << "ns"
+               << std::setw(4) << "< " << std::setw(10) << percentile(s.hold_hist, s.hold_samples, 0.99, 0) << "ns\n";
+        }
+    }
+
+private:
+    static constexpr std::size_t other_site = max_sites - 1;
+
+    std::mutex m_;
+    std::vector<std::string> names_;
+    std::vector<std::shared_ptr<std::array<site_stats, max_sites>>> tables_;
+
+    std::shared_ptr<std::array<site_stats, max_sites>> register_thread()
+    {
+        auto table = std::make_shared<std::array<site_stats, max_sites>>();
+        std::lock_guard lock(m_);
+        tables_.push_back(table);
+        return table;
+    }
+
+    // upper bound of the bucket the p-th sample falls into - count samples, from bucket `from` up (the waits start at 1,...
+    // ...as bucket 0 holds the uncontended (0ns) ones, which aren't in count)
+    static std::uint64_t percentile(const std::array<std::uint64_t, num_buckets> &hist, std::uint64_t count, double p, std::size_t from = 1)
+    {
+        if (!count) { return 0; }
+
+        std::uint64_t target = static_cast<std::uint64_t>(p * count), seen = 0;
+        for (std::size_t b = from; b != num_buckets; ++b) {
+            seen += hist[b];
+            if (seen > target) { return std::uint64_t(1) << b; }
+        }
+
+        return std::uint64_t(1) << (num_buckets - 1);
+    }
+};
+
+inline void report(std::ostream &os = std::cout) { registry::instance().report(os); }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// wraps any mutex (std::mutex, std::shared_mutex, hierarchical_mutex, ...) and can be dropped in wherever it was used
+template <typename Mutex = std::mutex>
+class mutex {
+public:
+    explicit mutex(const char *name = nullptr, std::source_location loc = std::source_location::current())
+        : site_(registry::instance().site_for(name ? name : site_name(loc))) { }
+
+    mutex(const mutex&) = delete;
+    mutex& operator=(const mutex&) = delete;
+
+    void lock()
+    {
+        site_stats &s = registry::instance().stats(site_);
+
+        // uncontended fast path - no clock reads for the wait, one counter bump
+        if (m_.try_lock()) {
+            bump(s.acquisitions);
+            bump(s.wait_hist[0]);
+            start_hold(s, false);
+            return;
+        }
+
+        auto start = clock_type::now();
+        m_.lock();
+        record_wait(s, ns_since(start));
+        start_hold(s, true);
+    }
+
+    bool try_lock()
+    {
+        if (!m_.try_lock()) { return false; }
+
+        site_stats &s = registry::instance().stats(site_);
+        bump(s.acquisitions);
+        bump(s.wait_hist[0]);
+        start_hold(s, false);
+        return true;
+    }
+
+    void unlock()
+    {
+        bool timed = timing_hold_;
+        auto start = hold_start_;
+        timing_hold_ = false;
+
+        m_.unlock();
+
+        if (timed) {
+            site_stats &s = registry::instance().stats(site_);
+            std::uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start).count();
+            bump(s.hold_samples);
+            bump(s.hold_ns, ns);
+            bump(s.hold_hist[bucket_for(ns)]);
+        }
+    }
+
+    // shared locking - many threads can hold it at once, so only the wait is recorded (no hold time)
+    void lock_shared() requires requires (Mutex &m) { m.lock_shared(); }
+    {
+        site_stats &s = registry::instance().stats(site_);
+
+        if (m_.try_lock_shared()) {
+            bump(s.acquisitions);
+            bump(s.wait_hist[0]);
+            return;
+        }
+
+        auto start = clock_type::now();
+        m_.lock_shared();
+        record_wait(s, ns_since(start));
+    }
+
+    bool try_lock_shared() requires requires (Mutex &m) { m.try_lock_shared(); }
+    {
+        if (!m_.try_lock_shared()) { return false; }
+        site_stats &s = registry::instance().stats(site_);
+        bump(s.acquisitions);
+        bump(s.wait_hist[0]);
+        return true;
+    }
+
+    void unlock_shared() requires requires (Mutex &m) { m.unlock_shared(); } { m_.unlock_shared(); }
+
+private:
+    Mutex m_;
+    const std::size_t site_;
+
+    // only touched by whoever holds the exclusive lock
+    bool timing_hold_ = false;
+    clock_type::time_point hold_start_;
+
+    static std::string site_name(const std::source_location &loc)
+    {
+        std::string file = loc.file_name();
+        return file.substr(file.find_last_of('/') + 1) + ':' + std::to_string(loc.line());
+    }
+
+    static void record_wait(site_stats &s, std::uint64_t ns)
+    {
+        bump(s.acquisitions);
+        bump(s.contended);
+        bump(s.wait_ns, ns);
+        bump(s.wait_hist[bucket_for(ns)]);
+    }
+
+    void start_hold(site_stats &s, bool contended)
+    {
+        // contended locks are the interesting ones, so always time those
+        if (contended || !(s.acquisitions.load(std::memory_order_relaxed) % hold_sample_rate)) {
+            timing_hold_ = true;
+            hold_start_ = clock_type::now();
+        }
+    }
+};
+} // namespace prof (profiler)
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+struct dns_entry {
+    std::string ip_addr = "0.0.0.0";
+};
+
+// dns_cache from Chapter 3 - only the mutex has changed
+class dns_cache {
+public:
+    dns_entry find_entry(const std::string &domain) const
+    {
+        std::shared_lock lock(entry_mutex);
+        auto it = entries.find(domain);
+        return it == entries.end() ? dns_entry() : it->second;
+    }
+
+    void update_or_add_entry(const std::string &domain, const dns_entry &dns_details)
+    {
+        std::lock_guard lock(entry_mutex);
+        entries[domain] = dns_details;
+    }
+
+private:
+    std::map<std::string, dns_entry> entries;
+    mutable prof::mutex<std::shared_mutex> entry_mutex{"dns_cache"};
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// a deliberately coarse "queue" - one lock, held while we do some busy work
+class work_queue {
+public:
+    void push(int i)
+    {
+        std::lock_guard lock(m_);
+        data_.push_back(i);
+        volatile int sink = 0;
+        for (int spin = 0; spin != 200; ++spin) { sink = sink + spin; } // pretend to do something under the lock
+    }
+
+    bool try_pop(int &i)
+    {
+        std::lock_guard lock(m_);
+        if (data_.empty()) { return false; }
+        i = data_.back();
+        data_.pop_back();
+        return true;
+    }
+
+private:
+    std::vector<int> data_;
+    prof::mutex<> m_{"work_queue"};
+};
+
+// unnamed - reported by source location instead
+prof::mutex<> stats_mutex;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+int main()
+{
+    dns_cache cache;
+    cache.update_or_add_entry("Google", dns_entry{"8.8.8.8"} );
+
+    work_queue q;
+    std::size_t total = 0;
+
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t != 4; ++t) {
+        threads.emplace_back([&, t] () {
+            for (int i = 0; i != 20000; ++i) {
+                q.push(i);
+
+                if (!(i % 8)) { cache.find_entry("Google"); }
+                if (!(i % 1000) && !t) { cache.update_or_add_entry("Google", dns_entry{"8.8.4.4"} ); }
+
+                int val;
+                if (q.try_pop(val)) {
+                    std::lock_guard lock(stats_mutex);
+                    total += val;
+                }
+            }
+        });
+    }
+
+    for (auto &t : threads) { t.join(); }
+
+    std::cout << "total: " << total << "\n\n";
+
+    prof::report();
+
+    return 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+//  OUTPUT - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+// total: 799960000
+//
+// lock site                         acquired  contended        %   total wait      p99 wait  avg hold      p99 hold
+// work_queue                          160000          3   0.002%      11272us  <    4194304ns      36ns  <         64ns
+// contention_profiler.cpp:344          80000          2   0.003%       3822us  <    4194304ns      37ns  <         64ns
+// dns_cache                            10021          0   0.000%          0us  <          0ns     168ns  <        256ns
+// Program ended with exit code: 0